@@ -0,0 +1,70 @@
+/*
+	Reference producer for the OE Tracker shared memory transport.
+
+	Publishes a blob moving on a circle to a tracking shared memory ring, the
+	way a tracker running on the acquisition machine would. Set the node's
+	"Shared memory" parameter to the same name and a source's address to the
+	one given here.
+
+	Build (Linux):
+		g++ -O2 -std=c++17 -I../../Source tracking_shm_producer.cpp ../../Source/TrackingShm.cpp -o tracking_shm_producer -lrt
+
+	Run:
+		./tracking_shm_producer [name=/oe_tracking] [address=/red] [rate=60]
+*/
+
+#include "TrackingShm.h"
+
+#include <chrono>
+#include <cmath>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+
+static volatile std::sig_atomic_t running = 1;
+
+static void stop(int)
+{
+	running = 0;
+}
+
+int main(int argc, char **argv)
+{
+	const char *name = argc > 1 ? argv[1] : "/oe_tracking";
+	const char *address = argc > 2 ? argv[2] : "/red";
+	const double rate = argc > 3 ? std::atof(argv[3]) : 60.0;
+
+	TrackingShmRing ring;
+	if (!ring.create(name))
+	{
+		std::perror("could not create shared memory");
+		return 1;
+	}
+	std::signal(SIGINT, stop);
+	std::signal(SIGTERM, stop);
+	std::printf("publishing %s on %s at %.1f Hz, Ctrl-C stops\n", address, name, rate);
+
+	TrackingShmRecord record{};
+	std::strncpy(record.address, address, TRACKING_SHM_ADDRESS_SIZE - 1);
+	record.nBlobs = 1;
+
+	const auto start = std::chrono::steady_clock::now();
+	const auto period = std::chrono::duration<double>(1.0 / rate);
+	for (int64_t frame = 0; running; ++frame)
+	{
+		const auto due = start + std::chrono::duration_cast<std::chrono::steady_clock::duration>(period * (double)frame);
+		std::this_thread::sleep_until(due);
+
+		const double t = std::chrono::duration<double>(due - start).count();
+		record.frame = frame;
+		record.cameraTime = t * 1000.0;
+		record.blobs[0][0] = (float)(0.5 + 0.3 * std::cos(t));
+		record.blobs[0][1] = (float)(0.5 + 0.3 * std::sin(t));
+		record.blobs[0][2] = 0.05f;
+		record.blobs[0][3] = 0.05f;
+		ring.publish(record);
+	}
+	return 0;
+}
@@ -0,0 +1,152 @@
+/*
+------------------------------------------------------------------
+
+This file is part of the Open Ephys GUI
+Copyright (C) 2022 Open Ephys
+
+------------------------------------------------------------------
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "TrackingAssignment.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+TrackingIdentities::TrackingIdentities()
+    : m_capacity(MAX_IDENTITIES)
+{
+    reset();
+}
+
+void TrackingIdentities::reset()
+{
+    for (int t = 0; t < MAX_IDENTITIES; ++t)
+        m_tracks[t].active = false;
+}
+
+void TrackingIdentities::setCapacity(int capacity)
+{
+    m_capacity = std::max(1, std::min(capacity, MAX_IDENTITIES));
+    reset();
+}
+
+bool TrackingIdentities::isValid(const TrackingPosition &blob)
+{
+    // Bonsai reports a lost blob as NaN or as exactly (0, 0)
+    return std::isfinite(blob.x) && std::isfinite(blob.y) && !(blob.x == 0 && blob.y == 0);
+}
+
+void TrackingIdentities::assign(const TrackingPosition *blobs, int n, uint64 timestamp, int *identities)
+{
+    n = std::min(n, MAX_IDENTITIES);
+
+    // release identities that have not been seen for a while
+    for (int t = 0; t < m_capacity; ++t)
+    {
+        if (m_tracks[t].active && timestamp > m_tracks[t].lastSeen + IDENTITY_TIMEOUT_MS)
+            m_tracks[t].active = false;
+    }
+
+    int nCandidates = 0;
+    for (int b = 0; b < n; ++b)
+    {
+        identities[b] = -1;
+        if (!isValid(blobs[b]))
+            continue;
+
+        for (int t = 0; t < m_capacity; ++t)
+        {
+            const Track &track = m_tracks[t];
+            if (!track.active)
+                continue;
+            // a timestamp mapped from the camera clock can land just before lastSeen
+            const float dt = std::max<int64>(0, (int64)timestamp - (int64)track.lastSeen) * 0.001f;
+            const float distance = std::hypot(blobs[b].x - (track.x + track.vx * dt),
+                                              blobs[b].y - (track.y + track.vy * dt));
+            if (distance <= IDENTITY_GATE)
+                m_candidates[nCandidates++] = {distance, b, t};
+        }
+    }
+
+    std::sort(m_candidates, m_candidates + nCandidates,
+              [](const Candidate &a, const Candidate &b) { return a.distance < b.distance; });
+
+    bool trackTaken[MAX_IDENTITIES] = {false};
+    for (int c = 0; c < nCandidates; ++c)
+    {
+        const Candidate &candidate = m_candidates[c];
+        if (identities[candidate.blob] != -1 || trackTaken[candidate.track])
+            continue;
+        identities[candidate.blob] = candidate.track;
+        trackTaken[candidate.track] = true;
+    }
+
+    for (int b = 0; b < n; ++b)
+    {
+        if (!isValid(blobs[b]))
+            continue;
+
+        if (identities[b] == -1)
+        {
+            // unmatched blobs take the lowest free identity
+            for (int t = 0; t < m_capacity; ++t)
+            {
+                if (!m_tracks[t].active && !trackTaken[t])
+                {
+                    identities[b] = t;
+                    trackTaken[t] = true;
+                    m_tracks[t] = {true, timestamp, blobs[b].x, blobs[b].y, 0, 0};
+                    break;
+                }
+            }
+            if (identities[b] != -1)
+                continue;
+
+            // none is free: an animal moved faster than the gate and its old
+            // track still holds the slot, take the nearest track left over
+            float nearest = std::numeric_limits<float>::max();
+            for (int t = 0; t < m_capacity; ++t)
+            {
+                if (trackTaken[t])
+                    continue;
+                const float distance = std::hypot(blobs[b].x - m_tracks[t].x, blobs[b].y - m_tracks[t].y);
+                if (distance < nearest)
+                {
+                    nearest = distance;
+                    identities[b] = t;
+                }
+            }
+            if (identities[b] != -1)
+            {
+                trackTaken[identities[b]] = true;
+                m_tracks[identities[b]] = {true, timestamp, blobs[b].x, blobs[b].y, 0, 0};
+            }
+            continue;
+        }
+
+        Track &track = m_tracks[identities[b]];
+        if (timestamp > track.lastSeen)
+        {
+            const float dt = (timestamp - track.lastSeen) * 0.001f;
+            track.vx = (blobs[b].x - track.x) / dt;
+            track.vy = (blobs[b].y - track.y) / dt;
+        }
+        track.x = blobs[b].x;
+        track.y = blobs[b].y;
+        track.lastSeen = timestamp;
+    }
+}
@@ -0,0 +1,83 @@
+/*
+------------------------------------------------------------------
+
+This file is part of the Open Ephys GUI
+Copyright (C) 2022 Open Ephys
+
+------------------------------------------------------------------
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef TRACKINGASSIGNMENT_H
+#define TRACKINGASSIGNMENT_H
+
+#include "TrackingMessage.h"
+
+#define MAX_IDENTITIES 20
+// largest distance, in camera units, between a blob and the predicted
+// position of an identity for the two to be matched
+#define IDENTITY_GATE 0.1f
+// identities not matched for this long are released
+#define IDENTITY_TIMEOUT_MS 1000
+
+//	Keeps the identities of several animals seen on one address stable across
+//	frames. Every frame the blobs are matched to the constant-velocity
+//	prediction of each live identity by greedy nearest neighbour within
+//	IDENTITY_GATE; unmatched blobs start a new identity if one is free. All
+//	storage is sized for MAX_IDENTITIES so a frame costs at most a sort of
+//	MAX_IDENTITIES^2 candidates and never allocates.
+class TrackingIdentities
+{
+public:
+	TrackingIdentities();
+
+	void reset();
+
+	/** Limits the number of identities handed out, releasing all current ones */
+	void setCapacity(int capacity);
+
+	/** Writes the identity of each blob into identities, or -1 if the blob is
+		invalid or there are more valid blobs than identities. A blob no live
+		identity is gated to takes a free one or, if none is free, the nearest
+		identity left unmatched. n must not exceed MAX_IDENTITIES. */
+	void assign(const TrackingPosition *blobs, int n, uint64 timestamp, int *identities);
+
+	/** False for dropouts, a NaN or exactly (0, 0) position */
+	static bool isValid(const TrackingPosition &blob);
+
+private:
+	struct Track
+	{
+		bool active;
+		uint64 lastSeen;
+		float x;
+		float y;
+		float vx;
+		float vy;
+	};
+
+	struct Candidate
+	{
+		float distance;
+		int blob;
+		int track;
+	};
+
+	int m_capacity;
+	Track m_tracks[MAX_IDENTITIES];
+	Candidate m_candidates[MAX_IDENTITIES * MAX_IDENTITIES];
+};
+
+#endif
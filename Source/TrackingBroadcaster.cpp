@@ -0,0 +1,177 @@
+/*
+------------------------------------------------------------------
+
+This file is part of the Open Ephys GUI
+Copyright (C) 2022 Open Ephys
+
+------------------------------------------------------------------
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "TrackingBroadcaster.h"
+
+#include <algorithm>
+#include <cmath>
+
+TrackingBroadcaster::TrackingBroadcaster(const String &endpoints, const StringArray &addresses)
+    : Thread("Tracking Broadcast Thread")
+{
+    for (const String &address : addresses)
+        m_addresses.push_back(address.toStdString());
+
+    StringArray tokens = StringArray::fromTokens(endpoints, ", ;", "");
+    tokens.removeEmptyStrings();
+    for (const String &endpoint : tokens)
+    {
+        String host = endpoint.containsChar(':') ? endpoint.upToLastOccurrenceOf(":", false, false) : "127.0.0.1";
+        int port = endpoint.fromLastOccurrenceOf(":", false, false).getIntValue();
+        if (port <= 0 || port > 65535)
+        {
+            LOGC("Ignoring broadcast endpoint ", endpoint, ", expected host:port");
+            continue;
+        }
+        try
+        {
+            m_sockets.push_back(std::make_unique<UdpTransmitSocket>(IpEndpointName(host.toRawUTF8(), port)));
+            LOGC("Broadcasting tracking to ", host, ":", port);
+        }
+        catch (const std::exception &e)
+        {
+            LOGC("Could not open broadcast endpoint ", endpoint, ": ", String(e.what()));
+        }
+    }
+}
+
+TrackingBroadcaster::~TrackingBroadcaster()
+{
+    stopThread(1000);
+    if (m_overflows > 0)
+        LOGC("Broadcast dropped ", (int64)m_overflows.load(), " samples");
+}
+
+void TrackingBroadcaster::push(int source, const TrackingData &data, float direction)
+{
+    if (m_write - m_read.load(std::memory_order_acquire) >= BROADCAST_QUEUE_SIZE)
+    {
+        ++m_overflows;
+        return;
+    }
+    Sample &sample = m_queue[m_write % BROADCAST_QUEUE_SIZE];
+    sample.source = source;
+    sample.direction = direction;
+    sample.data = data;
+    ++m_write;
+}
+
+void TrackingBroadcaster::flush()
+{
+    if (m_committed.load(std::memory_order_relaxed) == m_write)
+        return;
+    m_committed.store(m_write, std::memory_order_release);
+    notify();
+}
+
+osc::uint64 TrackingBroadcaster::millisToNtp(double millis)
+{
+    const double seconds = millis / 1000.0 + 2208988800.0;
+    const double whole = std::floor(seconds);
+    return ((osc::uint64)whole << 32) | (osc::uint64)((seconds - whole) * 4294967296.0);
+}
+
+void TrackingBroadcaster::run()
+{
+    while (!threadShouldExit())
+    {
+        const uint32 committed = m_committed.load(std::memory_order_acquire);
+        uint32 read = m_read.load(std::memory_order_relaxed);
+        if (read == committed)
+        {
+            wait(100);
+            continue;
+        }
+
+        // copy out first so the slots can be reused while the packets are built
+        const int n = (int)jmin<uint32>(committed - read, BROADCAST_MAX_BLOCK);
+        for (int i = 0; i < n; ++i)
+            m_block[i] = m_queue[(read + i) % BROADCAST_QUEUE_SIZE];
+        m_read.store(read + n, std::memory_order_release);
+
+        sendBlock(m_block, n);
+    }
+}
+
+void TrackingBroadcaster::sendBlock(Sample *samples, int nSamples)
+{
+    // process() drains source by source, put the block back in time order
+    std::stable_sort(samples, samples + nSamples, [](const Sample &a, const Sample &b)
+                     { return a.data.timestamp < b.data.timestamp; });
+
+    int first = 0;
+    while (first < nSamples)
+    {
+        // a frame ends where one of its sources (and identity) comes round again
+        int last = first + 1;
+        while (last < nSamples)
+        {
+            bool repeat = false;
+            for (int i = first; i < last && !repeat; ++i)
+                repeat = samples[i].source == samples[last].source &&
+                         samples[i].data.identity == samples[last].data.identity;
+            if (repeat)
+                break;
+            ++last;
+        }
+
+        osc::OutboundPacketStream packet(m_buffer, BROADCAST_PACKET_SIZE);
+        try
+        {
+            packet << osc::BeginBundle(millisToNtp((double)samples[first].data.timestamp));
+            for (int i = first; i < last; ++i)
+            {
+                const Sample &s = samples[i];
+                if (s.source < 0 || s.source >= (int)m_addresses.size())
+                    continue;
+                packet << osc::BeginMessage(m_addresses[s.source].c_str())
+                       << (osc::int32)s.data.frame << (osc::int32)s.data.identity
+                       << s.data.position.x << s.data.position.y
+                       << s.data.position.width << s.data.position.height
+                       << s.direction << (osc::int32)s.data.quality
+                       << osc::EndMessage;
+            }
+            packet << osc::EndBundle;
+            send(packet);
+        }
+        catch (osc::Exception &e)
+        {
+            LOGC("Could not build broadcast packet: ", String(e.what()));
+        }
+        first = last;
+    }
+}
+
+void TrackingBroadcaster::send(const osc::OutboundPacketStream &packet)
+{
+    for (auto &socket : m_sockets)
+    {
+        try
+        {
+            socket->Send(packet.Data(), packet.Size());
+        }
+        catch (const std::exception &)
+        {
+            // nobody listening on a connected socket, try again with the next frame
+        }
+    }
+}
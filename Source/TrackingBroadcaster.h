@@ -0,0 +1,101 @@
+/*
+------------------------------------------------------------------
+
+This file is part of the Open Ephys GUI
+Copyright (C) 2022 Open Ephys
+
+------------------------------------------------------------------
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef TRACKINGBROADCASTER_H
+#define TRACKINGBROADCASTER_H
+
+#include <ProcessorHeaders.h>
+#include "TrackingMessage.h"
+
+#include "oscpack/osc/OscOutboundPacketStream.h"
+#include "oscpack/ip/UdpSocket.h"
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#define BROADCAST_QUEUE_SIZE 1024
+#define BROADCAST_PACKET_SIZE 8192
+// samples sent in one process() block, more are left for the next wakeup
+#define BROADCAST_MAX_BLOCK 256
+
+//	Sends the processed positions to other programs over OSC/UDP, from its own
+//	thread. The audio thread only copies samples into a lock-free queue with
+//	push() and makes a block's samples visible with flush(). The sender sorts a
+//	block's samples by time and packs each frame - up to the next repeat of a
+//	source - into one bundle, time tagged with the frame's capture time. Each
+//	sample is one message on its source's address:
+//		,iiffffff	frame (-1 if unknown), identity, x, y, width, height,
+//					direction (radians, NaN for single sources), quality flags
+//	Packets are built in a preallocated buffer and sent to every endpoint.
+class TrackingBroadcaster : public Thread
+{
+public:
+	/** endpoints is a list of host:port, a port alone meaning localhost.
+		addresses are the OSC addresses of the trackers, by index. */
+	TrackingBroadcaster(const String &endpoints, const StringArray &addresses);
+	~TrackingBroadcaster();
+
+	/** True if at least one endpoint could be opened */
+	bool isValid() const { return !m_sockets.empty(); }
+
+	/** Audio thread: queues one processed sample of tracker source */
+	void push(int source, const TrackingData &data, float direction);
+
+	/** Audio thread: hands the samples pushed since the last flush to the sender */
+	void flush();
+
+	/** Samples dropped because the sender fell behind */
+	uint64 overflows() const { return m_overflows; }
+
+	void run() override;
+
+	/** Converts milliseconds on the host's wall clock to an OSC (NTP) time tag */
+	static osc::uint64 millisToNtp(double millis);
+
+private:
+	struct Sample
+	{
+		int source;
+		float direction;
+		TrackingData data;
+	};
+
+	void sendBlock(Sample *samples, int nSamples);
+	void send(const osc::OutboundPacketStream &packet);
+
+	std::vector<std::unique_ptr<UdpTransmitSocket>> m_sockets;
+	std::vector<std::string> m_addresses;
+
+	Sample m_queue[BROADCAST_QUEUE_SIZE];
+	uint32 m_write = 0; // audio thread only
+	std::atomic<uint32> m_committed{0};
+	std::atomic<uint32> m_read{0};
+	std::atomic<uint64> m_overflows{0};
+
+	char m_buffer[BROADCAST_PACKET_SIZE];
+	Sample m_block[BROADCAST_MAX_BLOCK];
+
+	JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(TrackingBroadcaster);
+};
+
+#endif
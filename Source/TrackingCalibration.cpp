@@ -0,0 +1,184 @@
+/*
+------------------------------------------------------------------
+
+This file is part of the Open Ephys GUI
+Copyright (C) 2022 Open Ephys
+
+------------------------------------------------------------------
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "TrackingCalibration.h"
+
+#include <cmath>
+
+TrackingCalibration::TrackingCalibration()
+{
+    setIdentity();
+}
+
+void TrackingCalibration::setIdentity()
+{
+    const double identity[9] = {1, 0, 0, 0, 1, 0, 0, 0, 1};
+    setHomography(identity);
+    m_k1 = m_k2 = m_cx = m_cy = 0;
+    m_hasDistortion = false;
+    m_isIdentity = true;
+}
+
+void TrackingCalibration::setHomography(const double *h)
+{
+    // normalise so the last coefficient is 1
+    const double scale = h[8] != 0 ? 1.0 / h[8] : 1.0;
+    for (int i = 0; i < 9; ++i)
+        m_h[i] = (float)(h[i] * scale);
+    m_isIdentity = false;
+}
+
+void TrackingCalibration::setDistortion(float k1, float k2, float cx, float cy)
+{
+    m_k1 = k1;
+    m_k2 = k2;
+    m_cx = cx;
+    m_cy = cy;
+    m_hasDistortion = k1 != 0 || k2 != 0;
+    m_isIdentity = false;
+}
+
+bool TrackingCalibration::setFromCorrespondences(const double *src, const double *dst)
+{
+    // X = (h0 x + h1 y + h2) / (h6 x + h7 y + 1), Y likewise with h3..h5:
+    // two linear equations per point pair in the eight unknowns h0..h7
+    double a[8][9];
+    for (int p = 0; p < 4; ++p)
+    {
+        const double x = src[2 * p], y = src[2 * p + 1];
+        const double X = dst[2 * p], Y = dst[2 * p + 1];
+        const double rowX[9] = {x, y, 1, 0, 0, 0, -x * X, -y * X, X};
+        const double rowY[9] = {0, 0, 0, x, y, 1, -x * Y, -y * Y, Y};
+        for (int c = 0; c < 9; ++c)
+        {
+            a[2 * p][c] = rowX[c];
+            a[2 * p + 1][c] = rowY[c];
+        }
+    }
+
+    // Gaussian elimination with partial pivoting
+    for (int col = 0; col < 8; ++col)
+    {
+        int pivot = col;
+        for (int r = col + 1; r < 8; ++r)
+        {
+            if (std::fabs(a[r][col]) > std::fabs(a[pivot][col]))
+                pivot = r;
+        }
+        if (std::fabs(a[pivot][col]) < 1e-12)
+            return false;
+        if (pivot != col)
+        {
+            for (int c = 0; c < 9; ++c)
+                std::swap(a[col][c], a[pivot][c]);
+        }
+        for (int r = 0; r < 8; ++r)
+        {
+            if (r == col)
+                continue;
+            const double factor = a[r][col] / a[col][col];
+            for (int c = col; c < 9; ++c)
+                a[r][c] -= factor * a[col][c];
+        }
+    }
+
+    double h[9];
+    for (int i = 0; i < 8; ++i)
+        h[i] = a[i][8] / a[i][i];
+    h[8] = 1;
+    setHomography(h);
+    return true;
+}
+
+bool TrackingCalibration::setFromString(const String &calibration)
+{
+    StringArray tokens = StringArray::fromTokens(calibration.trim(), " ,;", "");
+    tokens.removeEmptyStrings();
+
+    if (tokens.isEmpty())
+    {
+        setIdentity();
+        return true;
+    }
+
+    double values[16];
+    if (tokens.size() != 9 && tokens.size() != 13 && tokens.size() != 16)
+        return false;
+    for (int i = 0; i < tokens.size(); ++i)
+    {
+        // getDoubleValue reads a typo as 0, which would pass as a degenerate matrix
+        if (!tokens[i].containsOnly("0123456789.-+eE") || !tokens[i].containsAnyOf("0123456789"))
+            return false;
+        values[i] = tokens[i].getDoubleValue();
+    }
+
+    if (tokens.size() == 16)
+    {
+        double src[8], dst[8];
+        for (int p = 0; p < 4; ++p)
+        {
+            src[2 * p] = values[4 * p];
+            src[2 * p + 1] = values[4 * p + 1];
+            dst[2 * p] = values[4 * p + 2];
+            dst[2 * p + 1] = values[4 * p + 3];
+        }
+        TrackingCalibration solved;
+        if (!solved.setFromCorrespondences(src, dst))
+            return false;
+        *this = solved;
+        return true;
+    }
+
+    setIdentity();
+    setHomography(values);
+    if (tokens.size() == 13)
+        setDistortion((float)values[9], (float)values[10], (float)values[11], (float)values[12]);
+    return true;
+}
+
+void TrackingCalibration::apply(TrackingPosition &position) const
+{
+    if (m_isIdentity)
+        return;
+
+    float x = position.x;
+    float y = position.y;
+    float scale = 1;
+    if (m_hasDistortion)
+    {
+        const float dx = x - m_cx;
+        const float dy = y - m_cy;
+        const float r2 = dx * dx + dy * dy;
+        scale = 1 + r2 * (m_k1 + r2 * m_k2);
+        x = m_cx + dx * scale;
+        y = m_cy + dy * scale;
+    }
+
+    const float w = 1.0f / (m_h[6] * x + m_h[7] * y + m_h[8]);
+    const float X = (m_h[0] * x + m_h[1] * y + m_h[2]) * w;
+    const float Y = (m_h[3] * x + m_h[4] * y + m_h[5]) * w;
+
+    position.x = X;
+    position.y = Y;
+    position.width *= std::fabs((m_h[0] - X * m_h[6]) * w) * scale;
+    position.height *= std::fabs((m_h[4] - Y * m_h[7]) * w) * scale;
+}
@@ -0,0 +1,73 @@
+/*
+------------------------------------------------------------------
+
+This file is part of the Open Ephys GUI
+Copyright (C) 2022 Open Ephys
+
+------------------------------------------------------------------
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef TRACKINGCALIBRATION_H
+#define TRACKINGCALIBRATION_H
+
+#include "TrackingMessage.h"
+
+//	Maps camera coordinates of one source onto the arena, in centimetres.
+//	A calibration is a 3x3 homography, optionally preceded by a radial
+//	undistortion about a centre (cx, cy):
+//		r^2 = (x - cx)^2 + (y - cy)^2,  x' = cx + (x - cx) * (1 + k1 r^2 + k2 r^4)
+//	Everything is folded into plain coefficients when it is set, so applying
+//	it to a sample is a couple of dozen multiplies and one division.
+//
+//	As a string a calibration holds either the 9 homography coefficients in
+//	row-major order, the same followed by k1 k2 cx cy, or 16 numbers giving
+//	four "x y X Y" pairs of camera and arena points from which the homography
+//	is solved. An empty string is the identity.
+class TrackingCalibration
+{
+public:
+	TrackingCalibration();
+
+	void setIdentity();
+	bool isIdentity() const { return m_isIdentity; }
+
+	void setHomography(const double *h);
+	void setDistortion(float k1, float k2, float cx, float cy);
+
+	/** Solves the homography taking the four camera points src onto the four
+		arena points dst, both given as x0 y0 x1 y1 ... Returns false if the
+		points are degenerate. */
+	bool setFromCorrespondences(const double *src, const double *dst);
+
+	/** Parses a calibration string, see above. Returns false and leaves the
+		calibration unchanged if it can't be parsed. */
+	bool setFromString(const String &calibration);
+
+	/** Transforms a position in place. Width and height are scaled by the local
+		derivative of the mapping at the position. */
+	void apply(TrackingPosition &position) const;
+
+private:
+	float m_h[9];
+	float m_k1;
+	float m_k2;
+	float m_cx;
+	float m_cy;
+	bool m_hasDistortion;
+	bool m_isIdentity;
+};
+
+#endif
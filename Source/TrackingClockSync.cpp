@@ -0,0 +1,90 @@
+/*
+------------------------------------------------------------------
+
+This file is part of the Open Ephys GUI
+Copyright (C) 2022 Open Ephys
+
+------------------------------------------------------------------
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "TrackingClockSync.h"
+
+#include <cmath>
+
+TrackingClockSync::TrackingClockSync(double halfLife)
+    : m_lambda(std::pow(0.5, 1.0 / halfLife))
+{
+    reset();
+}
+
+void TrackingClockSync::reset()
+{
+    m_originX = 0;
+    m_originY = 0;
+    m_sumWeights = 0;
+    m_meanX = 0;
+    m_meanY = 0;
+    m_cxx = 0;
+    m_cxy = 0;
+    m_cyy = 0;
+    m_nPairs = 0;
+}
+
+void TrackingClockSync::addPair(double x, double y)
+{
+    if (m_nPairs == 0)
+    {
+        m_originX = x;
+        m_originY = y;
+    }
+    x -= m_originX;
+    y -= m_originY;
+
+    // weighted Welford update with forgetting: the means move towards the new
+    // pair and the co-moments are accumulated around the updated means
+    m_sumWeights = m_lambda * m_sumWeights + 1.0;
+    const double dx = x - m_meanX;
+    const double dy = y - m_meanY;
+    m_meanX += dx / m_sumWeights;
+    m_meanY += dy / m_sumWeights;
+    m_cxx = m_lambda * m_cxx + dx * (x - m_meanX);
+    m_cxy = m_lambda * m_cxy + dx * (y - m_meanY);
+    m_cyy = m_lambda * m_cyy + dy * (y - m_meanY);
+    ++m_nPairs;
+}
+
+bool TrackingClockSync::isValid() const
+{
+    return m_nPairs >= 2 && m_cxx > 1e-9 * m_sumWeights;
+}
+
+double TrackingClockSync::map(double x) const
+{
+    return m_originY + m_meanY + getRate() * (x - m_originX - m_meanX);
+}
+
+double TrackingClockSync::getRate() const
+{
+    return m_cxx > 0 ? m_cxy / m_cxx : 0.0;
+}
+
+double TrackingClockSync::getResidual() const
+{
+    if (!isValid())
+        return 0.0;
+    const double residual = m_cyy - m_cxy * m_cxy / m_cxx;
+    return std::sqrt(jmax(0.0, residual) / m_sumWeights);
+}
@@ -0,0 +1,71 @@
+/*
+------------------------------------------------------------------
+
+This file is part of the Open Ephys GUI
+Copyright (C) 2022 Open Ephys
+
+------------------------------------------------------------------
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef TRACKINGCLOCKSYNC_H
+#define TRACKINGCLOCKSYNC_H
+
+#include "TrackingMessage.h"
+
+//	Online estimate of the linear relation y = offset + rate * x between two
+//	clocks, for example host milliseconds and the sample counter of the
+//	acquisition board. Each pair updates exponentially forgotten weighted means
+//	and co-moments in O(1), so drift is followed without refitting the history
+//	and the fit stays numerically stable over multi-hour sessions.
+class TrackingClockSync
+{
+public:
+	/** halfLife is the number of pairs after which a pair's weight has halved */
+	explicit TrackingClockSync(double halfLife = 500.0);
+
+	void reset();
+
+	void addPair(double x, double y);
+
+	/** True once the pairs span enough of x to give a slope */
+	bool isValid() const;
+
+	/** Maps x to the y clock. Only meaningful when isValid() */
+	double map(double x) const;
+
+	double getRate() const;
+
+	/** Weighted RMS distance of the pairs from the fit, in y units */
+	double getResidual() const;
+
+	int64 getNumPairs() const { return m_nPairs; }
+
+private:
+	double m_lambda;
+	// the first pair, subtracted from every pair so that the sums keep their
+	// precision with large absolute clock values
+	double m_originX;
+	double m_originY;
+	double m_sumWeights;
+	double m_meanX;
+	double m_meanY;
+	double m_cxx;
+	double m_cxy;
+	double m_cyy;
+	int64 m_nPairs;
+};
+
+#endif
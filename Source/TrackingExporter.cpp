@@ -0,0 +1,205 @@
+/*
+------------------------------------------------------------------
+
+This file is part of the Open Ephys GUI
+Copyright (C) 2022 Open Ephys
+
+------------------------------------------------------------------
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "TrackingExporter.h"
+#include "TrackingQuality.h"
+#include "TrackingAssignment.h"
+
+#define EXPORT_BLOCK 4096
+
+namespace
+{
+    // .npy version 1.0 header for a 1-d little endian array
+    bool writeNpyHeader(FileOutputStream &out, const char *descr, int64 count)
+    {
+        String dict = "{'descr': '" + String(descr) + "', 'fortran_order': False, 'shape': (" + String(count) + ",), }";
+        // magic (6) + version (2) + length (2) + dict + '\n', padded to 64 bytes
+        const int unpadded = 10 + dict.length() + 1;
+        dict += String::repeatedString(" ", (64 - unpadded % 64) % 64) + "\n";
+        const uint16 length = (uint16)dict.length();
+
+        const char magic[] = {'\x93', 'N', 'U', 'M', 'P', 'Y', 1, 0};
+        return out.write(magic, sizeof(magic)) &&
+               out.write(&length, sizeof(length)) &&
+               out.write(dict.toRawUTF8(), dict.length());
+    }
+
+    // writes one field of every record, in the given order, as a column file
+    template <typename T, typename Getter>
+    bool writeColumn(const File &file, const char *descr, const std::vector<uint32> &order, Getter get)
+    {
+        file.deleteFile();
+        FileOutputStream out(file);
+        if (out.failedToOpen() || !writeNpyHeader(out, descr, (int64)order.size()))
+            return false;
+
+        T block[EXPORT_BLOCK];
+        size_t n = 0;
+        for (size_t i = 0; i < order.size(); ++i)
+        {
+            block[n++] = get(order[i]);
+            if (n == EXPORT_BLOCK || i + 1 == order.size())
+            {
+                if (!out.write(block, n * sizeof(T)))
+                    return false;
+                n = 0;
+            }
+        }
+        out.flush();
+        return true;
+    }
+}
+
+TrackingExporter::TrackingExporter()
+    : Thread("Tracking Export Thread")
+{
+}
+
+TrackingExporter::~TrackingExporter()
+{
+    stopThread(5000);
+}
+
+void TrackingExporter::addLog(const File &log, const Array<float> &maxSpeeds, const Array<TrackingCalibration> &calibrations)
+{
+    {
+        const ScopedLock scopedLock(m_lock);
+        m_jobs.push_back({log, maxSpeeds, calibrations});
+    }
+    if (!isThreadRunning())
+        startThread();
+    notify();
+}
+
+void TrackingExporter::run()
+{
+    while (!threadShouldExit())
+    {
+        Job job;
+        bool hasJob = false;
+        {
+            const ScopedLock scopedLock(m_lock);
+            if (!m_jobs.empty())
+            {
+                job = m_jobs.front();
+                m_jobs.pop_front();
+                hasJob = true;
+            }
+        }
+        if (!hasJob)
+        {
+            wait(-1);
+            continue;
+        }
+
+        const double start = Time::getMillisecondCounterHiRes();
+        if (exportLog(job.log, job.maxSpeeds, job.calibrations, this))
+            LOGC("Exported ", job.log.getFullPathName(), " in ", (int)(Time::getMillisecondCounterHiRes() - start), " ms");
+        else if (!threadShouldExit())
+            LOGC("Could not export ", job.log.getFullPathName());
+    }
+}
+
+bool TrackingExporter::exportLog(const File &log, const Array<float> &maxSpeeds, const Array<TrackingCalibration> &calibrations,
+                                 Thread *thread)
+{
+    TrackingLogHeader header;
+    std::vector<TrackingLogRecord> records;
+    if (!TrackingLog::read(log, header, records))
+        return false;
+
+    const int nSources = (int)header.nSources;
+
+    // stable counting sort by source, records with an unknown source are dropped
+    std::vector<int64> offsets(nSources + 1, 0);
+    for (const auto &record : records)
+        if (record.sourceId < nSources)
+            ++offsets[record.sourceId + 1];
+    for (int s = 0; s < nSources; ++s)
+        offsets[s + 1] += offsets[s];
+
+    std::vector<uint32> order(offsets[nSources]);
+    std::vector<int64> next(offsets.begin(), offsets.end() - 1);
+    for (uint32 r = 0; r < records.size(); ++r)
+        if (records[r].sourceId < nSources)
+            order[next[records[r].sourceId]++] = r;
+
+    // one validator per source and blob index; blobs of multi-animal sources
+    // are not identity-matched in the raw log, so their jump flags are approximate
+    std::vector<uint8> quality(records.size(), 0);
+    OwnedArray<TrackingValidator> validators;
+    for (int v = 0; v < nSources * MAX_IDENTITIES; ++v)
+    {
+        auto validator = validators.add(new TrackingValidator());
+        validator->setMaxSpeed(v / MAX_IDENTITIES < maxSpeeds.size() ? maxSpeeds[v / MAX_IDENTITIES] : 0.0f);
+    }
+    for (uint32 r : order)
+    {
+        const TrackingLogRecord &record = records[r];
+        if (record.blob >= MAX_IDENTITIES)
+            continue;
+        TrackingValidator *validator = validators[record.sourceId * MAX_IDENTITIES + record.blob];
+        TrackingData data;
+        data.timestamp = record.timestamp;
+        data.position = {record.x, record.y, record.width, record.height};
+        // the speed thresholds are in calibrated units, dropouts are recognised raw
+        if (TrackingValidator::isDropout(data.position))
+            data.quality = QUALITY_DROPOUT;
+        else if (record.sourceId < calibrations.size())
+            calibrations.getReference(record.sourceId).apply(data.position);
+        validator->checkStale(record.timestamp);
+        quality[r] = validator->check(data);
+    }
+
+    File dir = log.getSiblingFile(log.getFileNameWithoutExtension() + "_columns");
+    if (!dir.createDirectory())
+        return false;
+
+    bool ok = true;
+    auto exiting = [thread]() { return thread != nullptr && thread->threadShouldExit(); };
+
+    ok = ok && !exiting() && writeColumn<uint64>(dir.getChildFile("timestamps.npy"), "<u8", order, [&](uint32 r) { return records[r].timestamp; });
+    ok = ok && !exiting() && writeColumn<float>(dir.getChildFile("x.npy"), "<f4", order, [&](uint32 r) { return records[r].x; });
+    ok = ok && !exiting() && writeColumn<float>(dir.getChildFile("y.npy"), "<f4", order, [&](uint32 r) { return records[r].y; });
+    ok = ok && !exiting() && writeColumn<float>(dir.getChildFile("width.npy"), "<f4", order, [&](uint32 r) { return records[r].width; });
+    ok = ok && !exiting() && writeColumn<float>(dir.getChildFile("height.npy"), "<f4", order, [&](uint32 r) { return records[r].height; });
+    ok = ok && !exiting() && writeColumn<uint8>(dir.getChildFile("quality.npy"), "|u1", order, [&](uint32 r) { return quality[r]; });
+    ok = ok && !exiting() && writeColumn<uint16>(dir.getChildFile("blob.npy"), "<u2", order, [&](uint32 r) { return records[r].blob; });
+
+    std::vector<uint32> sourceOrder(nSources + 1);
+    for (int s = 0; s <= nSources; ++s)
+        sourceOrder[s] = s;
+    ok = ok && !exiting() && writeColumn<int64>(dir.getChildFile("offsets.npy"), "<i8", sourceOrder, [&](uint32 s) { return offsets[s]; });
+
+    String sources = "index,name,address,port\n";
+    for (int s = 0; s < nSources; ++s)
+    {
+        const TrackingLogSource &source = header.sources[s];
+        sources += String(s) + "," +
+                   String::fromUTF8(source.name, (int)strnlen(source.name, sizeof(source.name))) + "," +
+                   String::fromUTF8(source.address, (int)strnlen(source.address, sizeof(source.address))) + "," +
+                   String(source.port) + "\n";
+    }
+    ok = ok && dir.getChildFile("sources.csv").replaceWithText(sources);
+
+    return ok && !exiting();
+}
@@ -0,0 +1,78 @@
+/*
+------------------------------------------------------------------
+
+This file is part of the Open Ephys GUI
+Copyright (C) 2022 Open Ephys
+
+------------------------------------------------------------------
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef TRACKINGEXPORTER_H
+#define TRACKINGEXPORTER_H
+
+#include <ProcessorHeaders.h>
+#include "TrackingLog.h"
+#include "TrackingCalibration.h"
+
+#include <deque>
+
+//	Converts a raw TrackingLog into one file per field so that analysis code can
+//	memory map the columns directly (numpy.load(..., mmap_mode='r')). For a log
+//	tracking_<date>.trk the directory tracking_<date>_columns holds:
+//		timestamps.npy	uint64, software ms
+//		x.npy, y.npy, width.npy, height.npy	float32
+//		quality.npy	uint8, TrackingQualityFlags
+//		blob.npy	uint16, index of the blob within its message
+//		offsets.npy	int64[nSources + 1], rows of source s are offsets[s]:offsets[s + 1]
+//		sources.csv	index, name, address, port
+//	Rows are grouped by source and keep their arrival order within it. Quality
+//	is recomputed with the same checks as the live pipeline, on positions
+//	calibrated like the live ones; the position columns stay raw.
+//
+//	Logs are queued and exported one after the other on a single thread, so
+//	that a new recording never waits for the previous export.
+class TrackingExporter : public Thread
+{
+public:
+	TrackingExporter();
+	~TrackingExporter();
+
+	/** Queues log for export and returns. maxSpeeds and calibrations hold the
+		jump threshold and calibration of each source in log order, a missing
+		speed disables the check and a missing calibration leaves it raw. */
+	void addLog(const File &log, const Array<float> &maxSpeeds, const Array<TrackingCalibration> &calibrations);
+
+	void run() override;
+
+	/** Exports log synchronously. Returns false if it can't be read or written. */
+	static bool exportLog(const File &log, const Array<float> &maxSpeeds, const Array<TrackingCalibration> &calibrations,
+						  Thread *thread = nullptr);
+
+private:
+	struct Job
+	{
+		File log;
+		Array<float> maxSpeeds;
+		Array<TrackingCalibration> calibrations;
+	};
+
+	CriticalSection m_lock;
+	std::deque<Job> m_jobs;
+
+	JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(TrackingExporter);
+};
+
+#endif
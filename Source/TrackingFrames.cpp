@@ -0,0 +1,104 @@
+/*
+------------------------------------------------------------------
+
+This file is part of the Open Ephys GUI
+Copyright (C) 2022 Open Ephys
+
+------------------------------------------------------------------
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "TrackingFrames.h"
+
+#include <cmath>
+
+TrackingFrameCounter::TrackingFrameCounter()
+{
+    reset();
+}
+
+void TrackingFrameCounter::reset()
+{
+    nFrames = 0;
+    nMissing = 0;
+    nDuplicates = 0;
+    nReordered = 0;
+    nRestarts = 0;
+    jitter = 0;
+    m_started = false;
+    m_newest = 0;
+    m_window = 0;
+    m_lastArrival = 0;
+    m_lastCameraTime = -1;
+    m_meanInterval = 0;
+}
+
+bool TrackingFrameCounter::addFrame(int64 frame, uint64 arrival, double cameraTime)
+{
+    ++nFrames;
+
+    if (m_started && frame > m_newest)
+    {
+        const int64 shift = frame - m_newest;
+        nMissing += (uint64)(shift - 1);
+        m_window = shift < FRAME_WINDOW ? (m_window << shift) | 1 : 1;
+        m_newest = frame;
+    }
+    else if (m_started && m_newest - frame < FRAME_WINDOW)
+    {
+        const uint64 bit = (uint64)1 << (m_newest - frame);
+        if (m_window & bit)
+        {
+            ++nDuplicates;
+            return false;
+        }
+        // counted as missing when the newer frame arrived
+        m_window |= bit;
+        ++nReordered;
+        if (nMissing > 0)
+            --nMissing;
+        return true;
+    }
+    else
+    {
+        if (m_started)
+            ++nRestarts;
+        m_started = true;
+        m_newest = frame;
+        m_window = 1;
+    }
+
+    // jitter only follows frames in order, late ones would count their delay twice
+    if (m_lastArrival != 0)
+    {
+        const double interval = (double)arrival - (double)m_lastArrival;
+        double deviation;
+        if (cameraTime >= 0 && m_lastCameraTime >= 0)
+        {
+            // difference of transit times between consecutive frames
+            deviation = interval - (cameraTime - m_lastCameraTime);
+        }
+        else
+        {
+            // without a camera clock, deviation from the mean interval
+            m_meanInterval += (interval - m_meanInterval) / 16.0;
+            deviation = interval - m_meanInterval;
+        }
+        jitter = jitter + ((float)std::fabs(deviation) - jitter) / 16.0f;
+    }
+    m_lastArrival = arrival;
+    m_lastCameraTime = cameraTime;
+    return true;
+}
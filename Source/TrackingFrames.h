@@ -0,0 +1,71 @@
+/*
+------------------------------------------------------------------
+
+This file is part of the Open Ephys GUI
+Copyright (C) 2022 Open Ephys
+
+------------------------------------------------------------------
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef TRACKINGFRAMES_H
+#define TRACKINGFRAMES_H
+
+#include "TrackingMessage.h"
+
+#include <atomic>
+
+// frames further behind the newest one than this are taken as a counter restart
+#define FRAME_WINDOW 64
+// camera time replaces the receive time once the clocks have been paired this often
+#define CAMERA_SYNC_MIN_PAIRS 50
+
+//	Per-source accounting of the optional frame counter sent ahead of the blobs.
+//	Frames are checked against a window of the FRAME_WINDOW most recent ones, so
+//	a late frame is told apart from a duplicate, and a frame first counted as
+//	missing is credited back when it arrives late. Counters can be read from
+//	any thread.
+class TrackingFrameCounter
+{
+public:
+	TrackingFrameCounter();
+
+	void reset();
+
+	/** Accounts for one frame received at arrival (software ms). cameraTime is
+		the camera clock in ms, or negative if the source doesn't send it.
+		Returns false for a duplicate, which must be dropped. */
+	bool addFrame(int64 frame, uint64 arrival, double cameraTime);
+
+	std::atomic<uint64> nFrames;
+	std::atomic<uint64> nMissing;
+	std::atomic<uint64> nDuplicates;
+	std::atomic<uint64> nReordered;
+	std::atomic<uint64> nRestarts;
+
+	/** Interarrival jitter in ms, smoothed as in RFC 3550 */
+	std::atomic<float> jitter;
+
+private:
+	bool m_started;
+	int64 m_newest;
+	uint64 m_window; // bit d is set if frame m_newest - d was received
+
+	uint64 m_lastArrival;
+	double m_lastCameraTime;
+	double m_meanInterval;
+};
+
+#endif
@@ -0,0 +1,108 @@
+/*
+------------------------------------------------------------------
+
+This file is part of the Open Ephys GUI
+Copyright (C) 2022 Open Ephys
+
+------------------------------------------------------------------
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "TrackingFusion.h"
+#include "TrackingQuality.h"
+
+#include <cmath>
+#include <limits>
+
+TrackingRigidBody::TrackingRigidBody(const String &name)
+    : name(name), m_size(0)
+{
+    reset();
+}
+
+void TrackingRigidBody::reset()
+{
+    for (int m = 0; m < MAX_GROUP_SIZE; ++m)
+        m_fresh[m] = false;
+}
+
+int TrackingRigidBody::addMember(int trackerIdx)
+{
+    if (m_size == MAX_GROUP_SIZE)
+        return -1;
+    m_trackers[m_size] = trackerIdx;
+    return m_size++;
+}
+
+bool TrackingRigidBody::addSample(int member, const TrackingData &sample, TrackingData &fused, float &direction)
+{
+    m_samples[member] = sample;
+    m_fresh[member] = true;
+
+    // samples too old to belong to this frame are dropped
+    bool complete = true;
+    for (int m = 0; m < m_size; ++m)
+    {
+        if (m_fresh[m] && sample.timestamp > m_samples[m].timestamp + FUSION_TOLERANCE_MS)
+            m_fresh[m] = false;
+        complete = complete && m_fresh[m];
+    }
+    if (!complete)
+        return false;
+
+    TrackingPosition sum = {0, 0, 0, 0};
+    TrackingPosition rear = {0, 0, 0, 0};
+    int nValid = 0;
+    int nRear = 0;
+    fused.quality = QUALITY_OK;
+    for (int m = 0; m < m_size; ++m)
+    {
+        m_fresh[m] = false;
+        const TrackingPosition &p = m_samples[m].position;
+        if (!std::isfinite(p.x) || !std::isfinite(p.y) || (m_samples[m].quality & QUALITY_UNUSABLE))
+            continue;
+        // only members that contribute pass on their flags
+        fused.quality |= m_samples[m].quality;
+        sum.x += p.x;
+        sum.y += p.y;
+        sum.width += p.width;
+        sum.height += p.height;
+        ++nValid;
+        if (m > 0)
+        {
+            rear.x += p.x;
+            rear.y += p.y;
+            ++nRear;
+        }
+    }
+
+    const float nan = std::numeric_limits<float>::quiet_NaN();
+    fused.timestamp = sample.timestamp;
+    if (nValid == 0)
+    {
+        fused.quality = QUALITY_DROPOUT;
+        fused.position = {nan, nan, nan, nan};
+        direction = nan;
+        return true;
+    }
+    fused.position = {sum.x / nValid, sum.y / nValid, sum.width / nValid, sum.height / nValid};
+
+    const TrackingPosition &front = m_samples[0].position;
+    if (nRear > 0 && std::isfinite(front.x) && std::isfinite(front.y) && !(m_samples[0].quality & QUALITY_UNUSABLE))
+        direction = std::atan2(front.y - rear.y / nRear, front.x - rear.x / nRear);
+    else
+        direction = nan;
+    return true;
+}
@@ -0,0 +1,68 @@
+/*
+------------------------------------------------------------------
+
+This file is part of the Open Ephys GUI
+Copyright (C) 2022 Open Ephys
+
+------------------------------------------------------------------
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef TRACKINGFUSION_H
+#define TRACKINGFUSION_H
+
+#include "TrackingMessage.h"
+
+#define MAX_GROUP_SIZE 4
+// samples of one group further apart than this are not considered the same frame
+#define FUSION_TOLERANCE_MS 5
+
+//	Fuses the LEDs mounted on one animal into a single rigid body. Samples of
+//	each member are collected until every member has reported within
+//	FUSION_TOLERANCE_MS of the others, at which point the frame is complete and
+//	produces one centroid and one head direction. The first member is taken as
+//	the front LED; the direction points from the mean of the remaining members
+//	towards it.
+class TrackingRigidBody
+{
+public:
+	TrackingRigidBody(const String &name);
+
+	void reset();
+
+	/** Adds a tracker to the body and returns its member index, or -1 if the
+		body is full */
+	int addMember(int trackerIdx);
+
+	int size() const { return m_size; }
+	int getTracker(int member) const { return m_trackers[member]; }
+
+	/** Stores a member sample. Samples must be added in timestamp order across
+		all members. Returns true and fills fused and direction (radians, NaN if
+		the front or every rear LED is missing) when the sample completes a frame.
+		Members flagged unusable are left out, the fused quality carries the
+		flags of the members used, or QUALITY_DROPOUT if there are none. */
+	bool addSample(int member, const TrackingData &sample, TrackingData &fused, float &direction);
+
+	String name;
+
+private:
+	int m_size;
+	int m_trackers[MAX_GROUP_SIZE];
+	TrackingData m_samples[MAX_GROUP_SIZE];
+	bool m_fresh[MAX_GROUP_SIZE];
+};
+
+#endif
@@ -0,0 +1,307 @@
+/*
+------------------------------------------------------------------
+
+This file is part of the Open Ephys GUI
+Copyright (C) 2022 Open Ephys
+
+------------------------------------------------------------------
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "TrackingLog.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+#define CHUNK_BYTES ((uint64)TRACKING_LOG_CHUNK_RECORDS * sizeof(TrackingLogRecord))
+
+TrackingLog::TrackingLog()
+    : m_header(nullptr), m_nextRecord(0), m_dropped(0), m_nChunks(0), m_fileSize(0), m_requestedChunk(0),
+      m_stopPreparing(false)
+#ifdef _WIN32
+    , m_file(INVALID_HANDLE_VALUE)
+#else
+    , m_file(-1)
+#endif
+{
+    for (auto &chunk : m_chunks)
+        chunk = nullptr;
+}
+
+TrackingLog::~TrackingLog()
+{
+    close();
+}
+
+bool TrackingLog::open(const File &file, const Array<TrackingLogSource> &sources)
+{
+    close();
+
+#ifdef _WIN32
+    m_file = CreateFileW(file.getFullPathName().toWideCharPointer(), GENERIC_READ | GENERIC_WRITE,
+                         FILE_SHARE_READ, NULL, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (m_file == INVALID_HANDLE_VALUE)
+        return false;
+#else
+    m_file = ::open(file.getFullPathName().toRawUTF8(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (m_file == -1)
+        return false;
+#endif
+
+    m_fileSize = 0;
+    if (resize(TRACKING_LOG_HEADER_BYTES))
+        m_header = (TrackingLogHeader *)map(0, TRACKING_LOG_HEADER_BYTES);
+    if (m_header == nullptr)
+    {
+        close();
+        return false;
+    }
+
+    m_header->magic = TRACKING_LOG_MAGIC;
+    m_header->version = TRACKING_LOG_VERSION;
+    m_header->headerSize = TRACKING_LOG_HEADER_BYTES;
+    m_header->recordSize = sizeof(TrackingLogRecord);
+    m_header->nSources = jmin(sources.size(), TRACKING_LOG_MAX_SOURCES);
+    m_header->nRecords = 0;
+    m_header->startTime = CoreServices::getSoftwareTimestamp();
+    for (uint32 i = 0; i < m_header->nSources; ++i)
+        m_header->sources[i] = sources[i];
+
+    m_nextRecord = 0;
+    m_dropped = 0;
+    m_nChunks = 0;
+
+    // the first chunk now, the following ones ahead of the writers
+    getChunk(0);
+    m_requestedChunk = 0;
+    m_stopPreparing = false;
+    m_preparer = std::thread(&TrackingLog::prepareChunks, this);
+    return true;
+}
+
+void TrackingLog::prepareChunks()
+{
+    uint64 prepared = 0;
+    std::unique_lock<std::mutex> lock(m_requestLock);
+    while (true)
+    {
+        m_requested.wait(lock, [this, prepared]() { return m_stopPreparing || m_requestedChunk > prepared; });
+        if (m_stopPreparing)
+            return;
+        prepared = m_requestedChunk;
+        lock.unlock();
+        getChunk(prepared);
+        lock.lock();
+    }
+}
+
+void TrackingLog::stopPreparing()
+{
+    if (!m_preparer.joinable())
+        return;
+    {
+        std::lock_guard<std::mutex> lock(m_requestLock);
+        m_stopPreparing = true;
+    }
+    m_requested.notify_one();
+    m_preparer.join();
+}
+
+void TrackingLog::close()
+{
+    stopPreparing();
+    const uint64 nRecords = m_nextRecord.load();
+
+    for (uint64 c = 0; c < m_nChunks; ++c)
+    {
+        if (TrackingLogRecord *chunk = m_chunks[c].exchange(nullptr))
+            unmap(chunk, CHUNK_BYTES);
+    }
+    m_nChunks = 0;
+
+    if (m_header != nullptr)
+    {
+        m_header->nRecords = nRecords;
+        unmap(m_header, TRACKING_LOG_HEADER_BYTES);
+        m_header = nullptr;
+        resize(TRACKING_LOG_HEADER_BYTES + nRecords * sizeof(TrackingLogRecord));
+        if (m_dropped > 0)
+            LOGC("Tracking log could not be extended, ", (int64)m_dropped.load(), " records lost");
+    }
+
+#ifdef _WIN32
+    if (m_file != INVALID_HANDLE_VALUE)
+        CloseHandle(m_file);
+    m_file = INVALID_HANDLE_VALUE;
+#else
+    if (m_file != -1)
+        ::close(m_file);
+    m_file = -1;
+#endif
+}
+
+void TrackingLog::write(uint16 sourceId, uint16 blob, uint32 sequence, const TrackingData &data)
+{
+    if (m_header == nullptr)
+        return;
+
+    const uint64 index = m_nextRecord.fetch_add(1, std::memory_order_relaxed);
+    if (index % TRACKING_LOG_CHUNK_RECORDS == TRACKING_LOG_CHUNK_RECORDS / 2)
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_requestLock);
+            m_requestedChunk = index / TRACKING_LOG_CHUNK_RECORDS + 1;
+        }
+        m_requested.notify_one();
+    }
+    TrackingLogRecord *chunk = getChunk(index / TRACKING_LOG_CHUNK_RECORDS);
+    if (chunk == nullptr)
+    {
+        ++m_dropped;
+        return;
+    }
+
+    TrackingLogRecord &record = chunk[index % TRACKING_LOG_CHUNK_RECORDS];
+    record.sourceId = sourceId;
+    record.blob = blob;
+    record.sequence = sequence;
+    record.x = data.position.x;
+    record.y = data.position.y;
+    record.width = data.position.width;
+    record.height = data.position.height;
+    record.timestamp = data.timestamp;
+}
+
+TrackingLogRecord *TrackingLog::getChunk(uint64 c)
+{
+    if (c >= TRACKING_LOG_MAX_CHUNKS)
+        return nullptr;
+
+    TrackingLogRecord *chunk = m_chunks[c].load(std::memory_order_acquire);
+    if (chunk != nullptr)
+        return chunk;
+
+    std::lock_guard<std::mutex> guard(m_growLock);
+    chunk = m_chunks[c].load(std::memory_order_relaxed);
+    if (chunk == nullptr)
+    {
+        const uint64 offset = TRACKING_LOG_HEADER_BYTES + c * CHUNK_BYTES;
+        if (offset + CHUNK_BYTES <= m_fileSize || resize(offset + CHUNK_BYTES))
+            chunk = (TrackingLogRecord *)map(offset, CHUNK_BYTES);
+        if (chunk != nullptr)
+        {
+            m_chunks[c].store(chunk, std::memory_order_release);
+            m_nChunks = jmax(m_nChunks, c + 1);
+        }
+    }
+    return chunk;
+}
+
+#ifdef _WIN32
+
+void *TrackingLog::map(uint64 offset, uint64 size)
+{
+    const uint64 end = offset + size;
+    HANDLE mapping = CreateFileMappingW(m_file, NULL, PAGE_READWRITE, (DWORD)(end >> 32), (DWORD)end, NULL);
+    if (mapping == NULL)
+        return nullptr;
+    void *address = MapViewOfFile(mapping, FILE_MAP_WRITE, (DWORD)(offset >> 32), (DWORD)offset, (SIZE_T)size);
+    // the view keeps the mapping object alive
+    CloseHandle(mapping);
+    return address;
+}
+
+void TrackingLog::unmap(void *address, uint64)
+{
+    UnmapViewOfFile(address);
+}
+
+bool TrackingLog::resize(uint64 size)
+{
+    LARGE_INTEGER position;
+    position.QuadPart = (LONGLONG)size;
+    if (!SetFilePointerEx(m_file, position, NULL, FILE_BEGIN) || !SetEndOfFile(m_file))
+        return false;
+    m_fileSize = size;
+    return true;
+}
+
+#else
+
+void *TrackingLog::map(uint64 offset, uint64 size)
+{
+    void *address = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, m_file, (off_t)offset);
+    return address == MAP_FAILED ? nullptr : address;
+}
+
+void TrackingLog::unmap(void *address, uint64 size)
+{
+    munmap(address, size);
+}
+
+bool TrackingLog::resize(uint64 size)
+{
+    if (ftruncate(m_file, (off_t)size) != 0)
+        return false;
+    m_fileSize = size;
+    return true;
+}
+
+#endif
+
+bool TrackingLog::read(const File &file, TrackingLogHeader &header, std::vector<TrackingLogRecord> &records)
+{
+    FileInputStream input(file);
+    if (input.failedToOpen())
+        return false;
+
+    if (input.read(&header, sizeof(header)) != (int)sizeof(header) ||
+        header.magic != TRACKING_LOG_MAGIC ||
+        header.version != TRACKING_LOG_VERSION ||
+        header.recordSize != sizeof(TrackingLogRecord))
+        return false;
+
+    const int64 available = (input.getTotalLength() - header.headerSize) / header.recordSize;
+    const bool closedCleanly = header.nRecords > 0;
+    const int64 nRecords = closedCleanly ? jmin((int64)header.nRecords, available) : available;
+
+    records.resize((size_t)jmax<int64>(0, nRecords));
+    input.setPosition(header.headerSize);
+    // one chunk per read, the size of a whole log does not fit read()'s int
+    size_t nRead = 0;
+    while (nRead < records.size())
+    {
+        const size_t n = jmin(records.size() - nRead, (size_t)TRACKING_LOG_CHUNK_RECORDS);
+        const int nBytes = input.read(records.data() + nRead, (int)(n * sizeof(TrackingLogRecord)));
+        nRead += (size_t)jmax(0, nBytes) / sizeof(TrackingLogRecord);
+        if (nBytes != (int)(n * sizeof(TrackingLogRecord)))
+            break;
+    }
+    records.resize(nRead);
+
+    if (!closedCleanly)
+    {
+        size_t n = 0;
+        while (n < records.size() && records[n].timestamp != 0)
+            ++n;
+        records.resize(n);
+    }
+    return true;
+}
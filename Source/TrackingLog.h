@@ -0,0 +1,144 @@
+/*
+------------------------------------------------------------------
+
+This file is part of the Open Ephys GUI
+Copyright (C) 2022 Open Ephys
+
+------------------------------------------------------------------
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef TRACKINGLOG_H
+#define TRACKINGLOG_H
+
+#include <ProcessorHeaders.h>
+#include "TrackingMessage.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+#define TRACKING_LOG_MAGIC 0x4B525454 // "TTRK"
+#define TRACKING_LOG_VERSION 1
+#define TRACKING_LOG_MAX_SOURCES 32
+// the header region and chunks are multiples of the 64 kB mapping granularity of Windows
+#define TRACKING_LOG_HEADER_BYTES 65536
+#define TRACKING_LOG_CHUNK_RECORDS (1 << 20)
+#define TRACKING_LOG_MAX_CHUNKS 4096
+
+//	On-disk layout of a raw tracking log (little endian):
+//		TrackingLogHeader, zero padded to TRACKING_LOG_HEADER_BYTES
+//		TrackingLogRecord[nRecords]
+//	nRecords is written when the log is closed. A log that was not closed
+//	cleanly ends at the first record with a zero timestamp.
+
+struct TrackingLogRecord
+{
+	uint64 timestamp; // receive time, software ms
+	uint16 sourceId;  // index into TrackingLogHeader::sources
+	uint16 blob;	  // index of the blob within its message
+	uint32 sequence;  // per-source arrival count
+	float x;
+	float y;
+	float width;
+	float height;
+};
+
+struct TrackingLogSource
+{
+	char name[64];
+	char address[32];
+	uint32 port;
+	uint32 reserved;
+};
+
+struct TrackingLogHeader
+{
+	uint32 magic;
+	uint32 version;
+	uint32 headerSize;
+	uint32 recordSize;
+	uint32 nSources;
+	uint32 reserved;
+	uint64 nRecords;
+	int64 startTime; // software ms
+	TrackingLogSource sources[TRACKING_LOG_MAX_SOURCES];
+};
+
+static_assert(sizeof(TrackingLogRecord) == 32, "tracking log records must stay 32 bytes");
+static_assert(sizeof(TrackingLogHeader) <= TRACKING_LOG_HEADER_BYTES, "tracking log header too large");
+
+//	Append-only raw log of every arrival, memory mapped in fixed-size chunks.
+//	Writers reserve a record with one atomic increment and copy it straight
+//	into the mapping; the only lock is taken by the writer that first reaches
+//	a new chunk, to extend the file and map it. Chunks stay mapped until the
+//	log is closed, so writers never see a mapping move under them. Writers run
+//	on the listener threads, so a helper thread extends the file and maps the
+//	next chunk once the current one is half full; a writer only does it itself
+//	if it gets there first.
+class TrackingLog
+{
+public:
+	TrackingLog();
+	~TrackingLog();
+
+	/** Creates the file and writes the header. Returns false on failure. */
+	bool open(const File &file, const Array<TrackingLogSource> &sources);
+
+	/** Writes the record count, trims the file and unmaps it */
+	void close();
+
+	bool isOpen() const { return m_header != nullptr; }
+
+	/** Appends one record. Safe to call from any number of threads. */
+	void write(uint16 sourceId, uint16 blob, uint32 sequence, const TrackingData &data);
+
+	/** Reads a complete log back. Returns false if the file is not a log. */
+	static bool read(const File &file, TrackingLogHeader &header, std::vector<TrackingLogRecord> &records);
+
+private:
+	TrackingLogRecord *getChunk(uint64 chunk);
+	/** Body of the helper thread, maps chunks as writers request them */
+	void prepareChunks();
+	void stopPreparing();
+	void *map(uint64 offset, uint64 size);
+	void unmap(void *address, uint64 size);
+	bool resize(uint64 size);
+
+	TrackingLogHeader *m_header;
+	std::atomic<TrackingLogRecord *> m_chunks[TRACKING_LOG_MAX_CHUNKS];
+	std::atomic<uint64> m_nextRecord;
+	std::atomic<uint64> m_dropped;
+	std::mutex m_growLock;
+	uint64 m_nChunks;
+	uint64 m_fileSize;
+
+	std::thread m_preparer;
+	std::mutex m_requestLock;
+	std::condition_variable m_requested;
+	uint64 m_requestedChunk;
+	bool m_stopPreparing;
+
+#ifdef _WIN32
+	void *m_file;
+#else
+	int m_file;
+#endif
+
+	JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(TrackingLog);
+};
+
+#endif
@@ -34,6 +34,11 @@
 
 #include <ProcessorHeaders.h>
 
+#include <cstring>
+
+// longest OSC address, with its terminator and padding, that sources can use
+#define OSC_ADDRESS_SIZE 64
+
 struct TrackingPosition {
     float x;
     float y;
@@ -44,6 +49,10 @@ struct TrackingPosition {
 struct TrackingData {
     uint64 timestamp;
     TrackingPosition position;
+    int identity = 0;
+    uint8 quality = 0;
+    int64 frame = -1; // frame counter sent by the source, -1 if none
+    int64 receiveTicks = 0; // high resolution receive time, for latency statistics
     friend std::ostream &operator<<(std::ostream &stream, const TrackingData &td){
         stream << "x: " << td.position.x << std::endl;
         stream << "y: " << td.position.y << std::endl;
@@ -53,6 +62,37 @@ struct TrackingData {
     };
 };
 
+// An OSC address encoded as in a packet: NUL terminated and zero padded to a
+// multiple of 4 bytes. Encoded once when a source is configured, so matching
+// a received address is a length compare and one memcmp.
+struct TrackingOscAddress
+{
+    char bytes[OSC_ADDRESS_SIZE];
+    int size; // padded length, 0 if the address is too long to match anything
+
+    TrackingOscAddress() { set(""); }
+    explicit TrackingOscAddress(const char *address) { set(address); }
+
+    void set(const char *address)
+    {
+        std::memset(bytes, 0, sizeof(bytes));
+        const size_t length = std::strlen(address);
+        size = length < OSC_ADDRESS_SIZE ? (int)paddedSize(length) : 0;
+        if (size > 0)
+            std::memcpy(bytes, address, length);
+    }
+
+    /** address must be in packet form, as returned by ReceivedMessage::AddressPattern() */
+    bool matches(const char *address, int addressSize) const
+    {
+        return size == addressSize && size > 0 && std::memcmp(bytes, address, (size_t)size) == 0;
+    }
+
+    bool operator==(const TrackingOscAddress &other) const { return matches(other.bytes, other.size); }
+
+    static size_t paddedSize(size_t length) { return (length + 4) & ~(size_t)3; }
+};
+
 struct TrackingSources
 {
     unsigned int eventIndex;
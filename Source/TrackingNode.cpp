@@ -44,44 +44,129 @@ void TrackingNodeSettings::updateTracker(int idx, Parameter * param, juce::var v
     if (param->getName().equalsIgnoreCase("Name"))
         trackers[idx]->m_name = value.toString();
     else if (param->getName().equalsIgnoreCase("Port"))
-        trackers[idx]->m_port = value.toString();
+        trackers[idx]->setPort(value.toString());
     else if (param->getName().equalsIgnoreCase("Address"))
-        trackers[idx]->m_address = value.toString();
+        trackers[idx]->setAddress(value.toString());
     else if (param->getName().equalsIgnoreCase("Color"))
         trackers[idx]->m_color = value.toString();
+    else if (param->getName().equalsIgnoreCase("Multicast"))
+        trackers[idx]->m_multicast = value.toString().trim();
+    else if (param->getName().equalsIgnoreCase("Reuse port"))
+        trackers[idx]->m_reusePort = (bool)value;
+    else if (param->getName().equalsIgnoreCase("TCP"))
+        trackers[idx]->m_tcp = (bool)value;
+    else if (param->getName().equalsIgnoreCase("Group"))
+        trackers[idx]->m_group = value.toString();
+    else if (param->getName().equalsIgnoreCase("Animals"))
+    {
+        trackers[idx]->m_animals = value.toString().getIntValue();
+        trackers[idx]->m_identities.setCapacity(trackers[idx]->m_animals);
+    }
+    else if (param->getName().equalsIgnoreCase("Calibration"))
+    {
+        if (trackers[idx]->m_calibration.setFromString(value.toString()))
+            trackers[idx]->m_calibrationString = value.toString();
+        else
+            LOGC("Could not parse calibration for ", trackers[idx]->m_name, ": ", value.toString());
+    }
+    else if (param->getName().equalsIgnoreCase("Max speed"))
+        trackers[idx]->setMaxSpeed(value.toString().getFloatValue());
 }
 
-TTLEventPtr TrackingNodeSettings::createEvent(int idx, int64 sample_number)
+void TrackingNodeSettings::updateGroups()
 {
-    auto position = trackers[idx]->m_messageQueue->pop();
-    if (!position) {
-        LOGC("position message NULL");
-        return nullptr;
+    groups.clear();
+    for (int i = 0; i < trackers.size(); ++i) {
+        TrackingModule *tracker = trackers[i];
+        tracker->m_groupIndex = -1;
+        tracker->m_groupMember = -1;
+        if (tracker->m_group.isEmpty())
+            continue;
+
+        int g = 0;
+        while (g < groups.size() && groups[g]->name != tracker->m_group)
+            ++g;
+        if (g == groups.size())
+            groups.add(new TrackingRigidBody(tracker->m_group));
+
+        int member = groups[g]->addMember(i);
+        if (member == -1) {
+            LOGC("Group ", tracker->m_group, " is full, ", tracker->m_name, " is tracked on its own");
+            continue;
+        }
+        tracker->m_groupIndex = g;
+        tracker->m_groupMember = member;
+    }
+}
+
+int TrackingNodeSettings::getOldestMember(int group)
+{
+    int oldest = -1;
+    uint64 oldestTimestamp = 0;
+    for (int m = 0; m < groups[group]->size(); ++m) {
+        TrackingData *next = trackers[groups[group]->getTracker(m)]->m_messageQueue->peek();
+        if (next != nullptr && (oldest == -1 || next->timestamp < oldestTimestamp)) {
+            oldest = m;
+            oldestTimestamp = next->timestamp;
+        }
     }
-    LOGC("got message");
+    return oldest;
+}
+
+TTLEventPtr TrackingNodeSettings::createEvent(int idx, const TrackingData &position, int64 sample_number, int64 board_sample, float direction)
+{
+    TRACKING_PROBE("create event");
+    TRACE_DEBUG("got message", idx);
     Array<float> pos;
-    pos.add(position->position.x);
-    pos.add(position->position.y);
-    pos.add(position->position.height);
-    pos.add(position->position.width);
+    pos.add(position.position.x);
+    pos.add(position.position.y);
+    pos.add(position.position.height);
+    pos.add(position.position.width);
     
     MetadataValuePtr p_pos = new MetadataValue(*desc_position);
     MetadataValuePtr p_port = new MetadataValue(*desc_port);
     MetadataValuePtr p_addr = new MetadataValue(*desc_address);
+    MetadataValuePtr p_dir = new MetadataValue(*desc_direction);
+    MetadataValuePtr p_id = new MetadataValue(*desc_identity);
+    MetadataValuePtr p_quality = new MetadataValue(*desc_quality);
+    MetadataValuePtr p_board = new MetadataValue(*desc_board_sample);
+    MetadataValuePtr p_frame = new MetadataValue(*desc_frame);
+    MetadataValuePtr p_loss = new MetadataValue(*desc_frame_loss);
+    MetadataValuePtr p_jitter = new MetadataValue(*desc_jitter);
     p_pos->setValue(pos);
     p_port->setValue(trackers[idx]->m_port);
     p_addr->setValue(trackers[idx]->m_address);
+    p_dir->setValue(direction);
+    p_id->setValue(position.identity);
+    p_quality->setValue(position.quality);
+    p_board->setValue(board_sample);
+    p_frame->setValue(position.frame);
+    const TrackingFrameCounter &frames = trackers[idx]->m_frames;
+    Array<int64> loss;
+    loss.add((int64)frames.nMissing);
+    loss.add((int64)frames.nDuplicates);
+    loss.add((int64)frames.nReordered);
+    p_loss->setValue(loss);
+    p_jitter->setValue((float)frames.jitter);
+    // same order as TrackingEventMetadata
     MetadataValueArray metadata;
     metadata.add(p_pos);
     metadata.add(p_port);
     metadata.add(p_addr);
-    LOGC("Creating TTL event");
+    metadata.add(p_dir);
+    metadata.add(p_id);
+    metadata.add(p_quality);
+    metadata.add(p_board);
+    metadata.add(p_frame);
+    metadata.add(p_loss);
+    metadata.add(p_jitter);
+    TRACE_DEBUG("Creating TTL event", idx);
     TTLEventPtr event = TTLEvent::createTTLEvent(trackers[idx]->eventChannel,
                                                  sample_number,
                                                  0,
                                                  true,
                                                  metadata);
-    LOGC("Created TTL event");
+    TRACE_DEBUG("Created TTL event", sample_number);
     return event;
 };
 
@@ -100,9 +185,25 @@ TrackingNode::TrackingNode()
     addCategoricalParameter(Parameter::GLOBAL_SCOPE, "Name", "Tracking source", {}, 0);
     addStringParameter(Parameter::GLOBAL_SCOPE, "Port", "Tracking source OSC port", "27020");
     addStringParameter(Parameter::GLOBAL_SCOPE, "Address", "Tracking source OSC address", "/red");
+    addStringParameter(Parameter::GLOBAL_SCOPE, "Group", "Sources sharing a group are fused into one rigid body", "");
+    addIntParameter(Parameter::GLOBAL_SCOPE, "Animals", "Number of animals sent as blobs on this source's address", 1, 1, MAX_IDENTITIES);
+    addStringParameter(Parameter::GLOBAL_SCOPE, "Calibration", "Camera to arena (cm) homography: 9 coefficients, 9 + k1 k2 cx cy, or four x y X Y point pairs", "");
+    addStringParameter(Parameter::GLOBAL_SCOPE, "Multicast", "IPv4 multicast group this source's port listens on, empty for unicast", "");
+    addBooleanParameter(Parameter::GLOBAL_SCOPE, "TCP", "Receive this source as SLIP framed OSC over TCP (OSC 1.1) instead of UDP", false);
+    addBooleanParameter(Parameter::GLOBAL_SCOPE, "Reuse port", "Share this source's port with other sources or processes (SO_REUSEPORT); needed on every source when several listen on one port", false);
+    addFloatParameter(Parameter::GLOBAL_SCOPE, "Max speed", "Samples moving faster than this (units/s) are flagged as jumps, 0 disables", 0.0f, 0.0f, 10000.0f, 1.0f);
+    addStringParameter(Parameter::GLOBAL_SCOPE, "Replay", "CSV file or .trk log of recorded tracking to play back instead of waiting for Bonsai", "");
+    addFloatParameter(Parameter::GLOBAL_SCOPE, "Replay speed", "Replay speed relative to real time, 0 plays as fast as possible", 1.0f, 0.0f, 1000.0f, 0.5f);
+    addStringParameter(Parameter::GLOBAL_SCOPE, "Shared memory", "Name of a shared memory ring written by a tracker on this machine, read alongside OSC", "");
+    addStringParameter(Parameter::GLOBAL_SCOPE, "Broadcast", "host:port endpoints that receive the processed positions as OSC bundles", "");
+    addIntParameter(Parameter::GLOBAL_SCOPE, "RT priority", "SCHED_FIFO priority of the listener threads, 0 keeps the default scheduler", 0, 0, 99);
+    addStringParameter(Parameter::GLOBAL_SCOPE, "CPU affinity", "CPUs the listener threads run on, e.g. 3 or 2-3, empty for any", "");
+    addBooleanParameter(Parameter::GLOBAL_SCOPE, "Lock memory", "Lock the process in RAM (mlockall) and prefault the listener stacks", false);
+    addBooleanParameter(Parameter::GLOBAL_SCOPE, "Busy poll", "Listeners spin on non-blocking reads instead of sleeping, one busy core each for the lowest latency", false);
+    addBooleanParameter(Parameter::GLOBAL_SCOPE, "Continuous", "Publish x, y, width, height and speed as continuous channels", false);
+    addBooleanParameter(Parameter::GLOBAL_SCOPE, "Log", "Write every received blob to a raw .trk log in the recording directory", false);
+    addBooleanParameter(Parameter::GLOBAL_SCOPE, "Profile", "Capture pipeline timings, written as a Chrome trace to the recording directory when switched off", false);
     m_positionIsUpdated = false;
-    m_isRecordingTimeLogged = false;
-    m_isAcquisitionTimeLogged = false;
 }
 
 AudioProcessorEditor *TrackingNode::createEditor()
@@ -118,6 +219,20 @@ String TrackingNode::getParameterValue(Parameter *param)
         val = param->getValueAsString();
     else if (param->getName().equalsIgnoreCase("address"))
         val = param->getValueAsString();
+    else if (param->getName().equalsIgnoreCase("group"))
+        val = param->getValueAsString();
+    else if (param->getName().equalsIgnoreCase("animals"))
+        val = param->getValueAsString();
+    else if (param->getName().equalsIgnoreCase("calibration"))
+        val = param->getValueAsString();
+    else if (param->getName().equalsIgnoreCase("max speed"))
+        val = param->getValueAsString();
+    else if (param->getName().equalsIgnoreCase("multicast"))
+        val = param->getValueAsString();
+    else if (param->getName().equalsIgnoreCase("reuse port"))
+        val = param->getValueAsString();
+    else if (param->getName().equalsIgnoreCase("tcp"))
+        val = param->getValueAsString();
     else if (param->getName().equalsIgnoreCase("name"))
     {
         CategoricalParameter *cparam = (CategoricalParameter *)param;
@@ -132,87 +247,117 @@ void TrackingNode::initialize(bool signalChainIsLoading) {
         DataStream::Settings streamsettings{"TrackingNode datastream",
                                             "Datastream for Tracking data received from Bonsai",
                                             "external.tracking.rawData",
-                                            150};
+                                            STREAM_SAMPLE_RATE};
 
         auto stream = new DataStream(streamsettings);
         dataStreams.add(stream);
         LOGC("Added ds");
         
         dataStreams.getLast()->addProcessor(processorInfo.get());
+
+        EventChannel::Settings s{EventChannel::Type::TTL,
+                                 "Tracking sync",
+                                 "On when recording starts and off when it stops, with the software time and sample number of the change",
+                                 "external.tracking.sync",
+                                 stream};
+        m_syncChannel = new EventChannel(s);
+        m_syncChannel->setIdentifier("trackingsync");
+        m_syncChannel->addProcessor(processorInfo.get());
+        m_syncChannel->addEventMetadata(*desc_sync_time);
+        m_syncChannel->addEventMetadata(*desc_sync_sample);
+        eventChannels.add(m_syncChannel);
         LOGC("Updated settings");
         m_isInitialized = true;
     }
 }
 
+TrackingModule *TrackingNode::createTracker(uint16 streamId, String moduleName, String port, String address, String color)
+{
+    auto nTrackers = settings[streamId]->trackers.size();
+    if (port.isEmpty() && nTrackers != 0)
+    {
+        std::vector<int> ports;
+        for (int i = 0; i < nTrackers; ++i)
+        {
+            auto p = settings[streamId]->getPort(i);
+            ports.push_back(p);
+        }
+        int maxPort = *std::max_element(ports.begin(), ports.end());
+        port = String(maxPort + 1);
+    }
+    if (port.isEmpty())
+        port = String(DEF_PORT);
+    String port_name = String(port);
+    if (color.isEmpty())
+        color = String(DEF_COLOR);
+    if (address.isEmpty())
+        address = String(DEF_ADDRESS);
+    LOGC("adding module");
+    auto tm = new TrackingModule(port_name, address, color, this);
+    LOGC("added module");
+    tm->m_name = moduleName;
+
+    EventChannel *events;
+    EventChannel::Settings s{EventChannel::Type::TTL,
+                            "Tracking data",
+                            "Tracking data received from Bonsai. x, y, width, height",
+                            "external.tracking.rawData",
+                            getDataStream(streamId)};
+    LOGC("creating event channel");
+    events = new EventChannel(s);
+    String id = "trackingsource";
+    events->setIdentifier(id);
+    events->addProcessor(processorInfo.get());
+    LOGC("added processor");
+    // add metadata
+    meta_name = new MetadataValue(*desc_name);
+    meta_name->setValue(moduleName);
+
+    meta_port = new MetadataValue(*desc_port);
+    meta_port->setValue(port_name);
+    meta_address = new MetadataValue(*desc_address);
+    meta_address->setValue(address);
+
+    // add some dummy pos data for now
+    Array<float> pos;
+    pos.add(-1);
+    pos.add(-1);
+    pos.add(-1);
+    pos.add(-1);
+    meta_position = new MetadataValue(*desc_position);
+    meta_position->setValue(pos);
+    events->addMetadata(desc_position.get(), meta_position);
+    events->addMetadata(desc_name.get(), meta_name);
+    events->addMetadata(desc_address.get(), meta_address);
+    events->addMetadata(desc_port.get(), meta_port);
+    events->addEventMetadata(*desc_position);
+    events->addEventMetadata(*desc_port);
+    events->addEventMetadata(*desc_address);
+    events->addEventMetadata(*desc_direction);
+    events->addEventMetadata(*desc_identity);
+    events->addEventMetadata(*desc_quality);
+    events->addEventMetadata(*desc_board_sample);
+    events->addEventMetadata(*desc_frame);
+    events->addEventMetadata(*desc_frame_loss);
+    events->addEventMetadata(*desc_jitter);
+    eventChannels.add(events);
+    tm->eventChannel = events;
+    return tm;
+}
+
 void TrackingNode::addTracker(String moduleName, String port, String address, String color)
 {
     settings.update(getDataStreams());
+    cacheTrackingSettings();
 
     for (auto stream : getDataStreams()) {
         if (stream->getName().equalsIgnoreCase("TrackingNode datastream")) {
-            if (port.isEmpty())
-                port = String(DEF_PORT);
-            auto nTrackers = settings[stream->getStreamId()]->trackers.size();
-            if (nTrackers != 0)
-            {
-                std::vector<int> ports;
-                for (int i = 0; i < nTrackers; ++i)
-                {
-                    auto p = settings[stream->getStreamId()]->getPort(i);
-                    ports.push_back(p);
-                }
-                int maxPort = *std::max_element(ports.begin(), ports.end());
-                port = String(maxPort + 1);
-            }
-            String port_name = String(port);
-            if (color.isEmpty())
-                color = String(DEF_COLOR);
-            if (address.isEmpty())
-                address = String(DEF_ADDRESS);
-            LOGC("adding module");
-            auto tm = new TrackingModule(port_name, address, color, this);
-            LOGC("added module");
-            tm->m_name = moduleName;
-
-            EventChannel *events;
-            EventChannel::Settings s{EventChannel::Type::TTL,
-                                    "Tracking data",
-                                    "Tracking data received from Bonsai. x, y, width, height",
-                                    "external.tracking.rawData",
-                                    getDataStream(stream->getStreamId())};
-            LOGC("creating event channel");
-            events = new EventChannel(s);
-            String id = "trackingsource";
-            events->setIdentifier(id);
-            events->addProcessor(processorInfo.get());
-            LOGC("added processor");
-            // add metadata
-            meta_name = new MetadataValue(*desc_name);
-            meta_name->setValue(moduleName);
-            
-            meta_port = new MetadataValue(*desc_port);
-            meta_port->setValue(port_name);
-            meta_address = new MetadataValue(*desc_address);
-            meta_address->setValue(address);
-
-            // add some dummy pos data for now
-            Array<float> pos;
-            pos.add(-1);
-            pos.add(-1);
-            pos.add(-1);
-            pos.add(-1);
-            meta_position = new MetadataValue(*desc_position);
-            meta_position->setValue(pos);
-            events->addMetadata(desc_position.get(), meta_position);
-            events->addMetadata(desc_name.get(), meta_name);
-            events->addMetadata(desc_address.get(), meta_address);
-            events->addMetadata(desc_port.get(), meta_port);
-            events->addEventMetadata(*desc_position);
-            events->addEventMetadata(*desc_port);
-            events->addEventMetadata(*desc_address);
-            eventChannels.add(events);
-            tm->eventChannel = events;
+            auto tm = createTracker(stream->getStreamId(), moduleName, port, address, color);
+            lock.enter();
             settings[stream->getStreamId()]->trackers.add(tm);
+            settings[stream->getStreamId()]->updateGroups();
+            lock.exit();
+            updateContinuousChannels();
             CoreServices::updateSignalChain(getEditor());
         }
     }
@@ -223,30 +368,172 @@ void TrackingNode::removeTracker(const String &moduleToRemove)
     for (auto &stream : getDataStreams())
     {
         if (stream->getName().equalsIgnoreCase("TrackingNode datastream")) {
+            lock.enter();
             settings[stream->getStreamId()]->removeTracker(moduleToRemove);
+            settings[stream->getStreamId()]->updateGroups();
+            lock.exit();
         }
     }
+    updateContinuousChannels();
     CoreServices::updateSignalChain(getEditor());
     settings.update(getDataStreams());
+    cacheTrackingSettings();
 }
 
 void TrackingNode::parameterValueChanged(Parameter *param)
 {
     if (getDataStreams().isEmpty())
         return;
+    if (param->getName().equalsIgnoreCase("Continuous"))
+    {
+        m_continuousEnabled = param->getValue();
+        updateContinuousChannels();
+        CoreServices::updateSignalChain(getEditor());
+        return;
+    }
+    if (param->getName().equalsIgnoreCase("Replay"))
+    {
+        m_replayFile = param->getValueAsString();
+        return;
+    }
+    if (param->getName().equalsIgnoreCase("Replay speed"))
+    {
+        m_replaySpeed = param->getValueAsString().getFloatValue();
+        return;
+    }
+    if (param->getName().equalsIgnoreCase("Shared memory"))
+    {
+        m_shmName = param->getValueAsString().trim();
+        return;
+    }
+    if (param->getName().equalsIgnoreCase("Broadcast"))
+    {
+        m_broadcastEndpoints = param->getValueAsString().trim();
+        return;
+    }
+    if (param->getName().equalsIgnoreCase("RT priority") || param->getName().equalsIgnoreCase("CPU affinity") ||
+        param->getName().equalsIgnoreCase("Lock memory") || param->getName().equalsIgnoreCase("Busy poll"))
+    {
+        if (param->getName().equalsIgnoreCase("RT priority"))
+            m_realtime.priority = param->getValueAsString().getIntValue();
+        else if (param->getName().equalsIgnoreCase("CPU affinity"))
+            m_realtime.cpuMask = TrackingRealtime::parseCpuList(param->getValueAsString());
+        else if (param->getName().equalsIgnoreCase("Busy poll"))
+            m_realtime.busyPoll = param->getValue();
+        else if (m_realtime.lockMemory != (bool)param->getValue())
+        {
+            m_realtime.lockMemory = param->getValue();
+            TrackingRealtime::lockMemory(m_realtime.lockMemory);
+        }
+        // the listeners pick up their scheduling as they start
+        for (auto stream : getDataStreams())
+            if (stream->getName().equalsIgnoreCase("TrackingNode datastream"))
+                for (auto tracker : settings[stream->getStreamId()]->trackers)
+                    tracker->restartServer(this);
+        return;
+    }
+    if (param->getName().equalsIgnoreCase("Log"))
+    {
+        m_logEnabled = param->getValue();
+        return;
+    }
+    if (param->getName().equalsIgnoreCase("Profile"))
+    {
+        if (param->getValue())
+        {
+            TrackingProfiler::startCapture();
+        }
+        else if (TrackingProfiler::isCapturing())
+        {
+            File file = CoreServices::getRecordingParentDirectory().getChildFile(
+                "tracking_profile_" + Time::getCurrentTime().formatted("%Y-%m-%d_%H-%M-%S") + ".json");
+            if (TrackingProfiler::stopCapture(file.getFullPathName().toStdString()))
+                LOGC("Wrote pipeline timings to ", file.getFullPathName());
+            else
+                LOGC("Could not write pipeline timings to ", file.getFullPathName());
+        }
+        return;
+    }
     auto src_name = getParameterValue(getParameter("Name"));
     for (auto stream : getDataStreams()) {
         if (stream->getName().equalsIgnoreCase("TrackingNode datastream")) {
             for (int i = 0; i < settings[stream->getStreamId()]->trackers.size(); ++i) {
                 if (settings[stream->getStreamId()]->getName(i) == src_name) {
+                    lock.enter();
                     settings[stream->getStreamId()]->updateTracker(i, param, getParameterValue(param));
+                    lock.exit();
                     if (param->getName().equalsIgnoreCase("name"))
                     {
                         auto *port = getParameter("Port");
                         auto *address = getParameter("Address");
+                        auto *group = getParameter("Group");
+                        auto *animals = getParameter("Animals");
+                        auto *calibration = getParameter("Calibration");
+                        auto *maxSpeed = getParameter("Max speed");
                         port->currentValue = settings[stream->getStreamId()]->getPort(i);
                         address->currentValue = settings[stream->getStreamId()]->getAddress(i);
+                        group->currentValue = settings[stream->getStreamId()]->getGroup(i);
+                        animals->currentValue = settings[stream->getStreamId()]->getAnimals(i);
+                        calibration->currentValue = settings[stream->getStreamId()]->getCalibration(i);
+                        maxSpeed->currentValue = settings[stream->getStreamId()]->getMaxSpeed(i);
+                        getParameter("Multicast")->currentValue = settings[stream->getStreamId()]->getMulticast(i);
+                        getParameter("Reuse port")->currentValue = settings[stream->getStreamId()]->getReusePort(i);
+                        getParameter("TCP")->currentValue = settings[stream->getStreamId()]->getTcp(i);
+                    }
+                    else if (param->getName().equalsIgnoreCase("port") || param->getName().equalsIgnoreCase("address"))
+                    {
+                        // only this tracker's listener moves, the others keep receiving
+                        TrackingModule *tracker = settings[stream->getStreamId()]->trackers[i];
+                        if (!tracker->rebindServer(this))
+                        {
+                            // the old socket is still bound, keep matching what arrives on it
+                            lock.enter();
+                            tracker->setPort(tracker->m_server->getPort());
+                            lock.exit();
+                            getParameter("Port")->currentValue = tracker->m_port;
+                            if (getEditor() != nullptr)
+                                getEditor()->updateView();
+                        }
                     }
+                    else if (param->getName().equalsIgnoreCase("multicast") || param->getName().equalsIgnoreCase("reuse port") ||
+                             param->getName().equalsIgnoreCase("tcp"))
+                    {
+                        settings[stream->getStreamId()]->trackers[i]->restartServer(this);
+                    }
+                    else if (param->getName().equalsIgnoreCase("group"))
+                    {
+                        lock.enter();
+                        settings[stream->getStreamId()]->updateGroups();
+                        lock.exit();
+                    }
+                }
+            }
+        }
+    }
+}
+
+void TrackingNode::updateContinuousChannels()
+{
+    continuousChannels.clear();
+    if (!m_continuousEnabled)
+        return;
+
+    const StringArray fields{"x", "y", "width", "height", "speed"};
+    for (auto stream : getDataStreams())
+    {
+        if (stream->getName().equalsIgnoreCase("TrackingNode datastream")) {
+            TrackingNodeSettings *module = settings[stream->getStreamId()];
+            for (auto tracker : module->trackers) {
+                for (int f = 0; f < NUM_CONTINUOUS_FIELDS; ++f) {
+                    ContinuousChannel::Settings s{ContinuousChannel::Type::AUX,
+                                                  tracker->m_name + " " + fields[f],
+                                                  "Tracking " + fields[f] + " resampled at " + String(STREAM_SAMPLE_RATE) + " Hz",
+                                                  "external.tracking.continuous",
+                                                  1.0f,
+                                                  getDataStream(stream->getStreamId())};
+                    auto chan = new ContinuousChannel(s);
+                    chan->addProcessor(processorInfo.get());
+                    continuousChannels.add(chan);
                 }
             }
         }
@@ -261,127 +548,599 @@ void TrackingNode::updateSettings()
         initialize(true);
         isEnabled = true;
     }
+    cacheTrackingSettings();
+}
+
+void TrackingNode::cacheTrackingSettings()
+{
+    TrackingNodeSettings *module = nullptr;
+    for (auto stream : getDataStreams())
+        if (stream->getName().equalsIgnoreCase("TrackingNode datastream"))
+            module = settings[stream->getStreamId()];
+    const ScopedLock scopedLock(lock);
+    m_trackingSettings = module;
+}
+
+void TrackingNode::openLog()
+{
+    Array<TrackingLogSource> sources;
+    for (auto stream : getDataStreams())
+    {
+        if (stream->getName().equalsIgnoreCase("TrackingNode datastream")) {
+            for (auto tracker : settings[stream->getStreamId()]->trackers) {
+                TrackingLogSource source = {};
+                tracker->m_name.copyToUTF8(source.name, sizeof(source.name));
+                tracker->m_address.copyToUTF8(source.address, sizeof(source.address));
+                source.port = (uint32)tracker->m_port.getIntValue();
+                sources.add(source);
+            }
+        }
+    }
+
+    File dir = CoreServices::getRecordingParentDirectory();
+    m_logFile = dir.getChildFile("tracking_" + Time::getCurrentTime().formatted("%Y-%m-%d_%H-%M-%S") + ".trk");
+
+    const ScopedLock lk(lock);
+    if (m_log.open(m_logFile, sources))
+        LOGC("Logging tracking data to ", m_logFile.getFullPathName());
+    else
+        LOGC("Could not create tracking log ", m_logFile.getFullPathName());
+}
+
+void TrackingNode::recordLatency(TrackingModule *tracker, const TrackingData &position, int64 ticks)
+{
+    static const double microsPerTick = 1.0e6 / (double)Time::getHighResolutionTicksPerSecond();
+    if (position.receiveTicks != 0 && ticks > position.receiveTicks)
+        tracker->m_stats.latency.record((uint64)((double)(ticks - position.receiveTicks) * microsPerTick));
+}
+
+int64 TrackingNode::getSampleNumber(uint64 timestamp, int nSamples) const
+{
+    // samples that arrived late are placed at the start of the block, never in a past one
+    int64 sample = ((int64)timestamp - m_sampleClockStartMillis) * STREAM_SAMPLE_RATE / 1000;
+    return jlimit(m_samplesProcessed, m_samplesProcessed + jmax(0, nSamples - 1), sample);
+}
+
+int64 TrackingNode::getBoardSample(uint64 timestamp) const
+{
+    if (!m_boardClock.isValid())
+        return -1;
+    return (int64)std::llround(m_boardClock.map((double)timestamp));
+}
+
+TTLEventPtr TrackingNode::createSyncEvent(bool recording, int64 softwareTime)
+{
+    if (m_syncChannel == nullptr)
+        return nullptr;
+
+    MetadataValuePtr p_time = new MetadataValue(*desc_sync_time);
+    MetadataValuePtr p_sample = new MetadataValue(*desc_sync_sample);
+    p_time->setValue(softwareTime);
+    p_sample->setValue(m_samplesProcessed);
+    // same order as TrackingSyncMetadata
+    MetadataValueArray metadata;
+    metadata.add(p_time);
+    metadata.add(p_sample);
+    return TTLEvent::createTTLEvent(m_syncChannel, m_samplesProcessed, 0, recording, metadata);
+}
+
+bool TrackingNode::startAcquisition()
+{
+    m_sampleClockStartMillis = CoreServices::getSoftwareTimestamp();
+    m_samplesProcessed = 0;
+    m_boardClock.reset();
+    for (auto stream : getDataStreams())
+    {
+        if (stream->getName().equalsIgnoreCase("TrackingNode datastream")) {
+            for (auto tracker : settings[stream->getStreamId()]->trackers) {
+                tracker->m_resampler.reset();
+                for (auto &validator : tracker->m_validators)
+                    validator.reset();
+                tracker->m_sequence = 0;
+                tracker->m_messageQueue->clear();
+                tracker->m_frames.reset();
+                tracker->m_cameraClock.reset();
+                tracker->m_stats.reset();
+            }
+            for (auto group : settings[stream->getStreamId()]->groups)
+                group->reset();
+        }
+    }
+
+    if (m_broadcastEndpoints.isNotEmpty())
+    {
+        StringArray addresses;
+        for (auto stream : getDataStreams())
+            if (stream->getName().equalsIgnoreCase("TrackingNode datastream"))
+                for (int i = 0; i < settings[stream->getStreamId()]->trackers.size(); ++i)
+                    addresses.add(settings[stream->getStreamId()]->getAddress(i));
+        m_broadcaster = std::make_unique<TrackingBroadcaster>(m_broadcastEndpoints, addresses);
+        if (m_broadcaster->isValid())
+            m_broadcaster->startThread();
+        else
+            m_broadcaster.reset();
+    }
+
+    m_wasRecording = false;
+    m_isAcquiring = true;
+
+    if (m_logEnabled)
+        openLog();
+
+    if (m_replayFile.isNotEmpty())
+    {
+        m_replay = std::make_unique<TrackingReplay>(this, File(m_replayFile), m_replaySpeed);
+        m_replay->startThread();
+    }
+
+    if (m_shmName.isNotEmpty())
+    {
+        m_shmReceiver = std::make_unique<TrackingShmReceiver>(this, m_shmName);
+        m_shmReceiver->startThread();
+    }
+    return true;
+}
+
+bool TrackingNode::stopAcquisition()
+{
+    m_isAcquiring = false;
+    m_replay.reset();
+    m_shmReceiver.reset();
+    m_broadcaster.reset();
+    bool logWritten = false;
+    {
+        const ScopedLock lk(lock);
+        logWritten = m_log.isOpen();
+        m_log.close();
+    }
+
+    for (auto stream : getDataStreams())
+    {
+        if (stream->getName().equalsIgnoreCase("TrackingNode datastream")) {
+            for (auto tracker : settings[stream->getStreamId()]->trackers) {
+                uint64 nSamples = 0, nDropouts = 0, nJumps = 0, nStale = 0;
+                for (const auto &v : tracker->m_validators)
+                {
+                    nSamples += v.nSamples;
+                    nDropouts += v.nDropouts;
+                    nJumps += v.nJumps;
+                    nStale += v.nStale;
+                }
+                LOGC(tracker->m_name, ": ", (int64)nSamples, " samples, ", (int64)nDropouts, " dropouts, ",
+                     (int64)nJumps, " jumps, ", (int64)nStale, " stale periods");
+                const TrackingFrameCounter &f = tracker->m_frames;
+                if (f.nFrames > 0)
+                    LOGC(tracker->m_name, ": ", (int64)f.nFrames, " frames, ", (int64)f.nMissing, " missing, ",
+                         (int64)f.nDuplicates, " duplicates, ", (int64)f.nReordered, " late, ",
+                         (int64)tracker->m_messageQueue->overflows(), " queue overflows, jitter ", (float)f.jitter, " ms");
+            }
+        }
+    }
+
+    if (m_boardClock.isValid())
+        LOGC("Board clock: ", m_boardClock.getRate() * 1000.0, " samples/s against software time, residual ",
+             m_boardClock.getResidual(), " samples");
+
+    if (logWritten)
+    {
+        // convert the log to columns off the message thread
+        Array<float> maxSpeeds;
+        Array<TrackingCalibration> calibrations;
+        for (auto stream : getDataStreams())
+            if (stream->getName().equalsIgnoreCase("TrackingNode datastream"))
+                for (auto tracker : settings[stream->getStreamId()]->trackers)
+                {
+                    maxSpeeds.add(tracker->getMaxSpeed());
+                    calibrations.add(tracker->m_calibration);
+                }
+
+        // queued behind any export still running from an earlier recording
+        if (m_exporter == nullptr)
+            m_exporter = std::make_unique<TrackingExporter>();
+        m_exporter->addLog(m_logFile, maxSpeeds, calibrations);
+    }
+    return true;
 }
 
 void TrackingNode::process(AudioBuffer<float> &buffer)
 {
-    LOGC("process");
-    // if (!m_positionIsUpdated) {
-    //     LOGC("pos not updated");
-    // }
-    // LOGC("Entering lock");
-    // lock.enter();
-    // LOGC("Lock entered");
-    // for (auto stream : getDataStreams())
-    // {
-    //     if (stream->getName().equalsIgnoreCase("TrackingNode datastream")) {
-    //         auto streamId = stream->getStreamId();
-    //         for (int i = 0; i < settings[streamId]->trackers.size(); ++i) {
-    //             TTLEventPtr event = settings[streamId]->createEvent(i, 0);
-    //             if ( event != nullptr )
-    //                 addEvent(event, 0);
-    //         }
-    //     }
-    // }
-    // LOGC("Exiting lock");
-    // lock.exit();
-    // LOGC("Lock exited");
-    // m_positionIsUpdated = false;
-}
-
-void TrackingNode::receiveMessage(int port, String address, const TrackingData &message)
-{
-    // for (auto stream : getDataStreams())
-    // {
-    //     if ( stream->getName().equalsIgnoreCase("TrackingNode datastream")) {
-    //         lock.enter();
-    //         for (int i = 0; i < settings[stream->getStreamId()]->trackers.size(); ++i) {
-                
-    //             if (CoreServices::getRecordingStatus())
-    //             {
-    //                 if (!m_isRecordingTimeLogged)
-    //                 {
-    //                     m_received_msg = 0;
-    //                     m_startingRecTimeMillis = Time::currentTimeMillis();
-    //                     m_isRecordingTimeLogged = true;
-    //                     std::cout << "Starting Recording Ts: " << m_startingRecTimeMillis << std::endl;
-    //                     // settings[stream->getStreamId()]->clearQueue(i);
-    //                     CoreServices::sendStatusMessage("Clearing queue before start recording");
-    //                 }
-    //             }
-    //             else
-    //             {
-    //                 m_isRecordingTimeLogged = false;
-    //             }
-    //             if (CoreServices::getAcquisitionStatus()) // && !CoreServices::getRecordingStatus())
-    //             {
-    //                 if (!m_isAcquisitionTimeLogged)
-    //                 {
-    //                     m_startingAcqTimeMillis = Time::currentTimeMillis();
-    //                     m_isAcquisitionTimeLogged = true;
-    //                     std::cout << "Starting Acquisition at Ts: " << m_startingAcqTimeMillis << std::endl;
-    //                     settings[stream->getStreamId()]->clearQueue(i);
-    //                     CoreServices::sendStatusMessage("Clearing queue before start acquisition");
-    //                 }
-    //                 // LOGC("m_positionIsUpdated: ", m_positionIsUpdated);
-    //                 // m_positionIsUpdated = true;
-
-    //                 int64 ts = CoreServices::getSoftwareTimestamp();
-
-    //                 TrackingData outputMessage = message;
-    //                 outputMessage.timestamp = ts;
-    //                 settings[stream->getStreamId()]->pushMessage(i, outputMessage);
-    //                 m_received_msg++;
-    //             }
-    //             else
-    //                 m_isAcquisitionTimeLogged = false;
-    //         }
-    //         lock.exit();
-    //     }
-    // }
-}
-
-// TODO: Both I/O methods need finishing
+    TRACKING_PROBE("process");
+    TRACE_DEBUG("process", m_samplesProcessed);
+    for (auto stream : getDataStreams())
+    {
+        if (stream->getName().equalsIgnoreCase("TrackingNode datastream")) {
+            auto streamId = stream->getStreamId();
+            TrackingNodeSettings *module = settings[streamId];
+
+            // the stream has no hardware clock, so its sample count follows software time
+            int64 now = CoreServices::getSoftwareTimestamp();
+            int64 target = (now - m_sampleClockStartMillis) * STREAM_SAMPLE_RATE / 1000;
+            int nSamples = (int)jlimit<int64>(0, buffer.getNumSamples(), target - m_samplesProcessed);
+            m_boardClock.addPair((double)now, (double)CoreServices::getGlobalTimestamp());
+
+            // the recording state is checked once per block, not per message
+            const bool recording = CoreServices::getRecordingStatus();
+            const int64 ticks = Time::getHighResolutionTicks();
+
+            const int64_t drainStart = TrackingProfiler::isCapturing() ? TrackingProfiler::now() : -1;
+            lock.enter();
+            if (recording != m_wasRecording) {
+                m_wasRecording = recording;
+                if (recording) {
+                    // everything still queued arrived before the recording started
+                    int nDropped = 0;
+                    for (int i = 0; i < module->trackers.size(); ++i) {
+                        nDropped += module->trackers[i]->m_messageQueue->count();
+                        module->clearQueue(i);
+                    }
+                    for (auto group : module->groups)
+                        group->reset();
+                    LOGC("Recording started at sample ", m_samplesProcessed, ", software time ", now,
+                         ", dropped ", nDropped, " queued samples");
+                }
+                TTLEventPtr event = createSyncEvent(recording, now);
+                if (event != nullptr)
+                    addEvent(event, 0);
+            }
+            for (int i = 0; i < module->trackers.size(); ++i) {
+                TrackingModule *tracker = module->trackers[i];
+                for (int a = 0; a < tracker->m_animals; ++a)
+                    tracker->m_validators[a].checkStale(now);
+                if (tracker->m_groupIndex != -1)
+                    continue;
+                while (TrackingData *position = tracker->m_messageQueue->pop()) {
+                    position->quality = tracker->getValidator(position->identity).check(*position);
+                    // continuous output follows the first animal of a source
+                    if (position->identity == 0 && !(position->quality & QUALITY_UNUSABLE))
+                        tracker->m_resampler.addSample(*position);
+                    int64 sample = getSampleNumber(position->timestamp, nSamples);
+                    TTLEventPtr event = module->createEvent(i, *position, sample, getBoardSample(position->timestamp));
+                    if ( event != nullptr )
+                        addEvent(event, (int)(sample - m_samplesProcessed));
+                    if (m_broadcaster != nullptr && !(position->quality & QUALITY_UNUSABLE))
+                        m_broadcaster->push(i, *position, std::numeric_limits<float>::quiet_NaN());
+                    recordLatency(tracker, *position, ticks);
+                }
+            }
+            // grouped sources are merged in arrival order and emit one event per
+            // complete frame, on the channel of the group's first source
+            for (int g = 0; g < module->groups.size(); ++g) {
+                TrackingRigidBody *group = module->groups[g];
+                int member;
+                while ((member = module->getOldestMember(g)) != -1) {
+                    TrackingModule *tracker = module->trackers[group->getTracker(member)];
+                    TrackingData *position = tracker->m_messageQueue->pop();
+                    if (position->identity != 0)
+                        continue;
+                    position->quality = tracker->getValidator(position->identity).check(*position);
+                    if (!(position->quality & QUALITY_UNUSABLE))
+                        tracker->m_resampler.addSample(*position);
+                    recordLatency(tracker, *position, ticks);
+
+                    TrackingData fused;
+                    float direction;
+                    if (group->addSample(member, *position, fused, direction) && !(fused.quality & QUALITY_UNUSABLE)) {
+                        int64 sample = getSampleNumber(fused.timestamp, nSamples);
+                        TTLEventPtr event = module->createEvent(group->getTracker(0), fused, sample,
+                                                                getBoardSample(fused.timestamp), direction);
+                        if ( event != nullptr )
+                            addEvent(event, (int)(sample - m_samplesProcessed));
+                        if (m_broadcaster != nullptr)
+                            m_broadcaster->push(group->getTracker(0), fused, direction);
+                    }
+                }
+            }
+            lock.exit();
+            if (m_broadcaster != nullptr)
+                m_broadcaster->flush();
+            if (drainStart >= 0)
+                TrackingProfiler::record("process drain", drainStart, TrackingProfiler::now());
+
+            for (int i = 0; i < module->trackers.size(); ++i) {
+                TrackingModule *tracker = module->trackers[i];
+                int firstChannel = i * NUM_CONTINUOUS_FIELDS;
+                if (!m_continuousEnabled || firstChannel + NUM_CONTINUOUS_FIELDS > buffer.getNumChannels())
+                    continue;
+
+                float values[NUM_CONTINUOUS_FIELDS];
+                for (int n = 0; n < nSamples; ++n) {
+                    double t = m_sampleClockStartMillis - CONTINUOUS_DELAY_MS
+                               + (m_samplesProcessed + n) * 1000.0 / STREAM_SAMPLE_RATE;
+                    if (!tracker->m_resampler.getSample(t, STREAM_SAMPLE_RATE, values))
+                        std::fill(values, values + NUM_CONTINUOUS_FIELDS, 0.0f);
+                    for (int f = 0; f < NUM_CONTINUOUS_FIELDS; ++f)
+                        buffer.setSample(firstChannel + f, n, values[f]);
+                }
+            }
+
+            setTimestampAndSamples(m_samplesProcessed, now / 1000.0, nSamples, streamId);
+            m_samplesProcessed += nSamples;
+        }
+    }
+}
+
+TrackingModule *TrackingNode::getTracker(int trackerIdx)
+{
+    for (auto stream : getDataStreams())
+    {
+        if (stream->getName().equalsIgnoreCase("TrackingNode datastream")) {
+            if (trackerIdx >= 0 && trackerIdx < settings[stream->getStreamId()]->trackers.size())
+                return settings[stream->getStreamId()]->trackers[trackerIdx];
+        }
+    }
+    return nullptr;
+}
+
+int TrackingNode::getTrackerIndex(const String &name)
+{
+    for (auto stream : getDataStreams())
+    {
+        if (stream->getName().equalsIgnoreCase("TrackingNode datastream")) {
+            // also called from the replay thread while trackers may be added or removed
+            const ScopedLock scopedLock(lock);
+            for (int i = 0; i < settings[stream->getStreamId()]->trackers.size(); ++i) {
+                if (settings[stream->getStreamId()]->getName(i) == name)
+                    return i;
+            }
+        }
+    }
+    return -1;
+}
+
+bool TrackingNode::replayMessage(int trackerIdx, const TrackingData &data)
+{
+    for (auto stream : getDataStreams())
+    {
+        if (stream->getName().equalsIgnoreCase("TrackingNode datastream")) {
+            const ScopedLock scopedLock(lock);
+            TrackingNodeSettings *module = settings[stream->getStreamId()];
+            if (trackerIdx < 0 || trackerIdx >= module->trackers.size())
+                return true;
+            TrackingModule *tracker = module->trackers[trackerIdx];
+            if (tracker->m_messageQueue->count() > BUFFER_SIZE / 2)
+                return false;
+            TrackingData message = data;
+            message.receiveTicks = Time::getHighResolutionTicks();
+            module->pushMessage(trackerIdx, message);
+            tracker->m_stats.updateQueueDepth(tracker->m_messageQueue->count());
+        }
+    }
+    return true;
+}
+
+bool TrackingNode::replayBlobs(int trackerIdx, const TrackingPosition *blobs, int nBlobs, int64 ts)
+{
+    for (auto stream : getDataStreams())
+    {
+        if (stream->getName().equalsIgnoreCase("TrackingNode datastream")) {
+            const ScopedLock scopedLock(lock);
+            TrackingNodeSettings *module = settings[stream->getStreamId()];
+            if (trackerIdx < 0 || trackerIdx >= module->trackers.size())
+                return true;
+            if (module->trackers[trackerIdx]->m_messageQueue->count() > BUFFER_SIZE / 2)
+                return false;
+            deliverMessage(module, trackerIdx, blobs, nBlobs, -1, -1, ts, false);
+        }
+    }
+    return true;
+}
+
+void TrackingNode::receiveMessage(int port, const char *address, int addressSize, const TrackingPosition *blobs, int nBlobs,
+                                  int64 frame, double cameraTime)
+{
+    if (!m_isAcquiring)
+        return;
+    TRACKING_PROBE("queue push");
+
+    lock.enter();
+    TrackingNodeSettings *module = m_trackingSettings;
+    for (int i = 0; module != nullptr && i < module->trackers.size(); ++i) {
+        const TrackingModule *tracker = module->trackers[i];
+        if ((port != -1 && tracker->m_portNumber != port) || !tracker->m_oscAddress.matches(address, addressSize))
+            continue;
+        deliverMessage(module, i, blobs, nBlobs, frame, cameraTime, CoreServices::getSoftwareTimestamp());
+    }
+    lock.exit();
+}
+
+void TrackingNode::receiveBatch(int port, const TrackingPosition *blobs, int nBlobs, int64 frame, double cameraTime,
+                                const TrackingOscAddress *only)
+{
+    if (!m_isAcquiring)
+        return;
+    TRACKING_PROBE("queue push batch");
+
+    const int64 ts = CoreServices::getSoftwareTimestamp();
+    int next = 0;
+    lock.enter();
+    TrackingNodeSettings *module = m_trackingSettings;
+    for (int i = 0; module != nullptr && i < module->trackers.size() && next < nBlobs; ++i) {
+        TrackingModule *tracker = module->trackers[i];
+        if (tracker->m_portNumber != port)
+            continue;
+        // each source takes one blob per animal, in editor order
+        const int n = tracker->m_animals;
+        if (next + n > nBlobs)
+        {
+            ++tracker->m_stats.nParseErrors;
+            break;
+        }
+        if (only == nullptr || tracker->m_oscAddress == *only)
+            deliverMessage(module, i, blobs + next, n, frame, cameraTime, ts);
+        next += n;
+    }
+    lock.exit();
+}
+
+void TrackingNode::deliverMessage(TrackingNodeSettings *module, int i, const TrackingPosition *blobs, int nBlobs,
+                                  int64 frame, double cameraTime, int64 ts, bool log)
+{
+    // shared memory records may carry no blob at all, there is no sample to push
+    if (nBlobs <= 0)
+        return;
+    TrackingModule *tracker = module->trackers[i];
+    ++tracker->m_stats.nMessages;
+
+    TrackingData outputMessage;
+    outputMessage.timestamp = ts;
+    outputMessage.frame = frame;
+    outputMessage.receiveTicks = Time::getHighResolutionTicks();
+    // a duplicate is counted, but it is no new sample
+    if (frame >= 0 && !tracker->m_frames.addFrame(frame, ts, cameraTime))
+        return;
+    if (cameraTime >= 0)
+    {
+        // the camera clock has none of the network jitter of the receive time
+        tracker->m_cameraClock.addPair(cameraTime, (double)ts);
+        if (tracker->m_cameraClock.getNumPairs() >= CAMERA_SYNC_MIN_PAIRS)
+            ts = (int64)std::llround(tracker->m_cameraClock.map(cameraTime));
+    }
+    if (log && m_log.isOpen())
+    {
+        // raw blobs, before identity assignment and calibration
+        for (int b = 0; b < nBlobs; ++b)
+        {
+            outputMessage.position = blobs[b];
+            m_log.write((uint16)i, (uint16)b, tracker->m_sequence, outputMessage);
+        }
+    }
+    ++tracker->m_sequence;
+    outputMessage.timestamp = ts;
+    if (tracker->m_animals > 1)
+    {
+        int identities[MAX_IDENTITIES];
+        nBlobs = jmin(nBlobs, MAX_IDENTITIES);
+        tracker->m_identities.assign(blobs, nBlobs, ts, identities);
+        for (int b = 0; b < nBlobs; ++b)
+        {
+            if (identities[b] == -1)
+            {
+                // dropouts have no identity to lose
+                if (TrackingIdentities::isValid(blobs[b]))
+                    ++tracker->m_stats.nDropped;
+                continue;
+            }
+            outputMessage.position = blobs[b];
+            outputMessage.identity = identities[b];
+            tracker->m_calibration.apply(outputMessage.position);
+            module->pushMessage(i, outputMessage);
+        }
+    }
+    else
+    {
+        outputMessage.position = blobs[0];
+        // a dropout is recognised on the raw position, calibration would move it off (0, 0)
+        if (TrackingValidator::isDropout(outputMessage.position))
+            outputMessage.quality = QUALITY_DROPOUT;
+        else
+            tracker->m_calibration.apply(outputMessage.position);
+        module->pushMessage(i, outputMessage);
+    }
+    tracker->m_stats.updateQueueDepth(tracker->m_messageQueue->count());
+}
+
 void TrackingNode::saveCustomParametersToXml(XmlElement *parentElement)
 {
-    // for (auto stream : getDataStreams())
-    // {
-    //     auto *moduleXml = parentElement->createNewChildElement("Tracking_Node");
-    //     TrackingNodeSettings *module = settings[stream->getStreamId()];
-    //     for (auto tracker : module->trackers) {
-    //         moduleXml->setAttribute("Name", tracker->m_name);
-    //         moduleXml->setAttribute("Port", tracker->m_port);
-    //         moduleXml->setAttribute("Address", tracker->m_address);
-    //     }
-    // }
+    for (auto stream : getDataStreams())
+    {
+        if (!stream->getName().equalsIgnoreCase("TrackingNode datastream"))
+            continue;
+        const ScopedLock scopedLock(lock);
+        for (auto tracker : settings[stream->getStreamId()]->trackers) {
+            auto *moduleXml = parentElement->createNewChildElement("Tracking_Node");
+            moduleXml->setAttribute("Name", tracker->m_name);
+            moduleXml->setAttribute("Port", tracker->m_port);
+            moduleXml->setAttribute("Address", tracker->m_address);
+            moduleXml->setAttribute("Color", tracker->m_color);
+            moduleXml->setAttribute("Multicast", tracker->m_multicast);
+            moduleXml->setAttribute("ReusePort", tracker->m_reusePort);
+            moduleXml->setAttribute("Tcp", tracker->m_tcp);
+            moduleXml->setAttribute("Group", tracker->m_group);
+            moduleXml->setAttribute("Animals", tracker->m_animals);
+            moduleXml->setAttribute("Calibration", tracker->m_calibrationString);
+            moduleXml->setAttribute("MaxSpeed", (double)tracker->getMaxSpeed());
+        }
+    }
 }
 
 void TrackingNode::loadCustomParametersFromXml(XmlElement *xml)
 {
-    // for (auto *moduleXml : xml->getChildIterator())
-    // {
-    //     if (moduleXml->hasTagName("Tracking_Node"))
-    //     {
-    //         String name = moduleXml->getStringAttribute("Name", "Tracking source 1");
-    //         String address = moduleXml->getStringAttribute("Address", "/red");
-    //         String port = moduleXml->getStringAttribute("Port", "27020");
+    if (getDataStreams().isEmpty())
+        initialize(true);
+    settings.update(getDataStreams());
+    cacheTrackingSettings();
+
+    // create every module and channel first, then rebuild the signal chain once
+    StringArray names;
+    for (auto stream : getDataStreams())
+    {
+        if (!stream->getName().equalsIgnoreCase("TrackingNode datastream"))
+            continue;
+        TrackingNodeSettings *module = settings[stream->getStreamId()];
+        for (auto *moduleXml : xml->getChildIterator())
+        {
+            if (!moduleXml->hasTagName("Tracking_Node"))
+                continue;
+
+            String name = moduleXml->getStringAttribute("Name", "Tracking source " + String(names.size() + 1));
+            if (names.contains(name) || getTrackerIndex(name) != -1)
+                continue;
+
+            auto tm = createTracker(stream->getStreamId(), name,
+                                    moduleXml->getStringAttribute("Port", String(DEF_PORT)),
+                                    moduleXml->getStringAttribute("Address", DEF_ADDRESS),
+                                    moduleXml->getStringAttribute("Color", DEF_COLOR));
+            tm->m_group = moduleXml->getStringAttribute("Group");
+            tm->m_animals = jlimit(1, MAX_IDENTITIES, moduleXml->getIntAttribute("Animals", 1));
+            tm->m_identities.setCapacity(tm->m_animals);
+            String calibration = moduleXml->getStringAttribute("Calibration");
+            if (tm->m_calibration.setFromString(calibration))
+                tm->m_calibrationString = calibration;
+            tm->setMaxSpeed((float)moduleXml->getDoubleAttribute("MaxSpeed", 0.0));
+            tm->m_multicast = moduleXml->getStringAttribute("Multicast").trim();
+            tm->m_reusePort = moduleXml->getBoolAttribute("ReusePort", false);
+            tm->m_tcp = moduleXml->getBoolAttribute("Tcp", false);
+            if (tm->m_multicast.isNotEmpty() || tm->m_reusePort || tm->m_tcp)
+                tm->restartServer(this);
+
+            const ScopedLock scopedLock(lock);
+            module->trackers.add(tm);
+            names.add(name);
+        }
+        const ScopedLock scopedLock(lock);
+        module->updateGroups();
+    }
 
-    //         addTracker(name, port, address);
-    //     }
-    // }
+    if (names.isEmpty())
+        return;
+
+    CategoricalParameter *cparam = (CategoricalParameter *)getParameter("Name");
+    StringArray categories{cparam->getCategories()};
+    categories.addArray(names);
+    cparam->setCategories(categories);
+
+    updateContinuousChannels();
+    CoreServices::updateSignalChain(getEditor());
 }
 
 // Class TrackingQueue methods
 TrackingQueue::TrackingQueue()
     : m_head(-1), m_tail(-1)
 {
-    memset(m_buffer, 0, BUFFER_SIZE);
+    std::fill(m_buffer, m_buffer + BUFFER_SIZE, TrackingData());
 }
 
 TrackingQueue::~TrackingQueue() {}
 
 void TrackingQueue::push(const TrackingData &message)
 {
+    // when full, the oldest sample makes room rather than the queue wrapping onto itself
+    if (_count == BUFFER_SIZE - 1)
+    {
+        m_tail = (m_tail + 1) % BUFFER_SIZE;
+        --_count;
+        ++m_overflows;
+    }
     m_head = (m_head + 1) % BUFFER_SIZE;
     m_buffer[m_head] = message;
     ++_count;
@@ -397,6 +1156,14 @@ TrackingData *TrackingQueue::pop()
     return &(m_buffer[m_tail]);
 }
 
+TrackingData *TrackingQueue::peek()
+{
+    if (isEmpty())
+        return nullptr;
+
+    return &(m_buffer[(m_tail + 1) % BUFFER_SIZE]);
+}
+
 bool TrackingQueue::isEmpty()
 {
     return m_head == m_tail;
@@ -406,6 +1173,7 @@ void TrackingQueue::clear()
 {
     m_tail = -1;
     m_head = -1;
+    _count = 0;
 }
 
 int TrackingQueue::count() {
@@ -414,13 +1182,16 @@ int TrackingQueue::count() {
 
 // Class TrackingServer methods
 TrackingServer::TrackingServer()
-    : Thread("OscListener Thread"), m_incomingPort(0), m_address("")
+    : Thread("OscListener Thread"), m_incomingPort(0), m_address(""), m_portNumber(0)
 {
 }
 
-TrackingServer::TrackingServer(String port, String address)
-    : Thread("OscListener Thread"), m_incomingPort(port), m_address(address)
+TrackingServer::TrackingServer(String port, String address, String multicast, bool reusePort, bool tcp)
+    : Thread("OscListener Thread"), m_incomingPort(port), m_address(address), m_multicast(multicast.trim()), m_reusePort(reusePort),
+      m_tcp(tcp)
 {
+    m_portNumber = port.getIntValue();
+    m_oscAddress.set(address.toRawUTF8());
 }
 
 TrackingServer::~TrackingServer()
@@ -429,60 +1200,203 @@ TrackingServer::~TrackingServer()
     stop();
     stopThread(1000);
     waitForThreadToExit(1000);
-    delete m_listeningSocket;
 }
 
 void TrackingServer::ProcessMessage(const osc::ReceivedMessage &receivedMessage,
                                     const IpEndpointName &)
 {
-    // int64 ts = CoreServices::getGlobalTimestamp();
-    // try
-    // {
-    //     uint32 argumentCount = 4;
-
-    //     if (receivedMessage.ArgumentCount() != argumentCount)
-    //     {
-    //         LOGC("ERROR: TrackingServer received message with wrong number of arguments. ",
-    //             "Expected ", argumentCount, ", got ", receivedMessage.ArgumentCount());
-    //         return;
-    //     }
-
-    //     for (uint32 i = 0; i < receivedMessage.ArgumentCount(); i++)
-    //     {
-    //         if (receivedMessage.TypeTags()[i] != 'f')
-    //         {
-    //             LOGC("TrackingServer only support 'f' (floats), not '", String(receivedMessage.TypeTags()[i]));
-    //             return;
-    //         }
-    //     }
-
-    //     osc::ReceivedMessageArgumentStream args = receivedMessage.ArgumentStream();
-
-    //     TrackingData trackingData;
-
-    //     // Arguments:
-    //     args >> trackingData.position.x;      // 0 - x
-    //     args >> trackingData.position.y;      // 1 - y
-    //     args >> trackingData.position.width;  // 2 - box width
-    //     args >> trackingData.position.height; // 3 - box height
-    //     args >> osc::EndMessage;
-
-    //     for (TrackingNode *processor : m_processors)
-    //     {
-    //         if (std::strcmp(receivedMessage.AddressPattern(), m_address.toStdString().c_str()) != 0)
-    //         {
-    //             continue;
-    //         }
-    //         // add trackingmodule to receive message call: processor->receiveMessage (m_incomingPort, m_address, trackingData);
-    //         processor->receiveMessage(std::stoi(m_incomingPort.toStdString()), m_address, trackingData);
-    //     }
-    // }
-    // catch (osc::Exception &e)
-    // {
-    //     // any parsing errors such as unexpected argument types, or
-    //     // missing arguments get thrown as exceptions.
-    //     LOGC("error while parsing message: ", String(receivedMessage.AddressPattern()), ": ", String(e.what()));
-    // }
+    TRACKING_PROBE("osc parse");
+    static const TrackingOscAddress batchAddress(BATCH_ADDRESS);
+    const char *address = receivedMessage.AddressPattern();
+    const int addressSize = (int)TrackingOscAddress::paddedSize(std::strlen(address));
+    if (batchAddress.matches(address, addressSize))
+    {
+        ProcessBatch(receivedMessage);
+        return;
+    }
+    try
+    {
+        // Arguments: an optional int32 frame counter, optionally followed by the
+        // camera time in seconds as a double, then 4 floats per blob. Sources
+        // tracking several animals send their blobs back to back.
+        uint32 argumentCount = receivedMessage.ArgumentCount();
+        const char *tags = receivedMessage.TypeTags();
+
+        uint32 first = 0;
+        if (argumentCount > 0 && tags[0] == 'i')
+            first = (argumentCount > 1 && tags[1] == 'd') ? 2 : 1;
+        uint32 nFloats = argumentCount - first;
+
+        if (nFloats == 0 || nFloats % 4 != 0 || nFloats > 4 * MAX_IDENTITIES)
+        {
+            if (m_stats != nullptr)
+                ++m_stats->nParseErrors;
+            LOGC("ERROR: TrackingServer received message with wrong number of arguments. ",
+                "Expected [frame [camera time]] and a multiple of 4 floats, got ", receivedMessage.ArgumentCount());
+            return;
+        }
+
+        for (uint32 i = first; i < argumentCount; i++)
+        {
+            if (tags[i] != 'f')
+            {
+                if (m_stats != nullptr)
+                    ++m_stats->nParseErrors;
+                LOGC("TrackingServer only support 'f' (floats), not '", String(tags[i]));
+                return;
+            }
+        }
+
+        osc::ReceivedMessageArgumentStream args = receivedMessage.ArgumentStream();
+
+        int64 frame = -1;
+        double cameraTime = -1;
+        if (first >= 1)
+        {
+            osc::int32 counter;
+            args >> counter;
+            frame = counter;
+        }
+        if (first == 2)
+        {
+            double seconds;
+            args >> seconds;
+            cameraTime = seconds * 1000.0;
+        }
+        else if (m_bundleTime >= 0)
+        {
+            // the capture time the sender stamped on the enclosing bundle
+            cameraTime = m_bundleTime;
+        }
+
+        TrackingPosition blobs[MAX_IDENTITIES];
+        int nBlobs = nFloats / 4;
+
+        // Arguments, per blob:
+        for (int b = 0; b < nBlobs; ++b)
+        {
+            args >> blobs[b].x;      // 0 - x
+            args >> blobs[b].y;      // 1 - y
+            args >> blobs[b].width;  // 2 - box width
+            args >> blobs[b].height; // 3 - box height
+        }
+        args >> osc::EndMessage;
+
+        // every socket in a multicast group gets its own copy of a datagram, so
+        // each only forwards its own source. A unicast datagram on a reused port
+        // reaches a single socket, which forwards it whichever source it is for
+        if (isMulticast() && !m_oscAddress.matches(address, addressSize))
+            return;
+        for (TrackingNode *processor : m_processors)
+            processor->receiveMessage(m_portNumber, address, addressSize, blobs, nBlobs, frame, cameraTime);
+    }
+    catch (osc::Exception &e)
+    {
+        // any parsing errors such as unexpected argument types, or
+        // missing arguments get thrown as exceptions.
+        if (m_stats != nullptr)
+            ++m_stats->nParseErrors;
+        LOGC("error while parsing message: ", String(receivedMessage.AddressPattern()), ": ", String(e.what()));
+    }
+}
+
+void TrackingServer::ProcessPacket(const char *data, int size, const IpEndpointName &remoteEndpoint)
+{
+    if (m_stats != nullptr && m_socket != nullptr)
+    {
+        const long long latency = m_socket->LastReceiveLatencyNs();
+        if (latency >= 0)
+            m_stats->wakeup.record((uint64)(latency / 1000));
+    }
+    try
+    {
+        osc::OscPacketListener::ProcessPacket(data, size, remoteEndpoint);
+    }
+    catch (osc::Exception &e)
+    {
+        // a malformed packet must not end the listener
+        if (m_stats != nullptr)
+            ++m_stats->nParseErrors;
+        LOGC("error while parsing packet: ", String(e.what()));
+    }
+}
+
+void TrackingServer::ProcessBatch(const osc::ReceivedMessage &receivedMessage)
+{
+    try
+    {
+        // Arguments: the int32 frame counter, optionally the camera time in
+        // seconds as a double, then 4 floats per blob for every source on this
+        // port, decoded straight from the packet in one pass
+        uint32 argumentCount = receivedMessage.ArgumentCount();
+        const char *tags = receivedMessage.TypeTags();
+
+        const uint32 first = (argumentCount > 1 && tags[1] == 'd') ? 2 : 1;
+        const uint32 nFloats = argumentCount - first;
+        if (argumentCount == 0 || tags[0] != 'i' || nFloats == 0 || nFloats % 4 != 0 ||
+            nFloats > 4 * MAX_SOURCES * MAX_IDENTITIES || std::strspn(tags + first, "f") != nFloats)
+        {
+            if (m_stats != nullptr)
+                ++m_stats->nParseErrors;
+            LOGC("ERROR: TrackingServer received a " BATCH_ADDRESS " message with wrong arguments. ",
+                "Expected a frame, [camera time] and a multiple of 4 floats, got '", String(tags), "'");
+            return;
+        }
+
+        osc::ReceivedMessageArgumentIterator arg = receivedMessage.ArgumentsBegin();
+        const int64 frame = (arg++)->AsInt32Unchecked();
+        double cameraTime = m_bundleTime;
+        if (first == 2)
+            cameraTime = (arg++)->AsDoubleUnchecked() * 1000.0;
+
+        TrackingPosition blobs[MAX_SOURCES * MAX_IDENTITIES];
+        const int nBlobs = nFloats / 4;
+        for (int b = 0; b < nBlobs; ++b)
+        {
+            blobs[b].x = (arg++)->AsFloatUnchecked();
+            blobs[b].y = (arg++)->AsFloatUnchecked();
+            blobs[b].width = (arg++)->AsFloatUnchecked();
+            blobs[b].height = (arg++)->AsFloatUnchecked();
+        }
+
+        for (TrackingNode *processor : m_processors)
+            processor->receiveBatch(m_portNumber, blobs, nBlobs, frame, cameraTime, isMulticast() ? &m_oscAddress : nullptr);
+    }
+    catch (osc::Exception &e)
+    {
+        if (m_stats != nullptr)
+            ++m_stats->nParseErrors;
+        LOGC("error while parsing message: ", String(receivedMessage.AddressPattern()), ": ", String(e.what()));
+    }
+}
+
+void TrackingServer::ProcessBundle(const osc::ReceivedBundle &bundle, const IpEndpointName &remoteEndpoint)
+{
+    const double enclosingTime = m_bundleTime;
+    try
+    {
+        // a time tag of 1 means "immediately" and carries no time
+        const osc::uint64 timeTag = bundle.TimeTag();
+        if (timeTag != 1)
+            m_bundleTime = ntpToMillis(timeTag);
+        osc::OscPacketListener::ProcessBundle(bundle, remoteEndpoint);
+    }
+    catch (osc::Exception &e)
+    {
+        if (m_stats != nullptr)
+            ++m_stats->nParseErrors;
+        LOGC("error while parsing bundle: ", String(e.what()));
+    }
+    m_bundleTime = enclosingTime;
+}
+
+double TrackingServer::ntpToMillis(uint64 timeTag)
+{
+    // NTP counts seconds since 1900 with a 32 bit binary fraction, the host
+    // clock milliseconds since 1970
+    const int64 seconds = (int64)(timeTag >> 32) - 2208988800LL;
+    const double fraction = (double)(timeTag & 0xFFFFFFFFULL) / 4294967296.0;
+    return ((double)seconds + fraction) * 1000.0;
 }
 
 void TrackingServer::addProcessor(TrackingNode *processor)
@@ -497,29 +1411,232 @@ void TrackingServer::removeProcessor(TrackingNode *processor)
 
 void TrackingServer::run()
 {
-    // CoreServices::sendStatusMessage("Server sleeping!");
-    // sleep(1000);
-    // CoreServices::sendStatusMessage("Server running");
-    // // Start the oscpack OSC Listener Thread
-    // try
-    // {
-    //     m_listeningSocket = new UdpListeningReceiveSocket(IpEndpointName("localhost", std::stoi(m_incomingPort.toStdString())), this);
-    //     sleep(1000);
-    //     m_listeningSocket->Run();
-    // }
-    // catch (const std::exception &e)
-    // {
-    //     LOGC("Exception in TrackingServer::run(): ", String(e.what()));
-    // }
+    if (!m_processors.empty() && m_processors.front()->getRealtimeConfig().isEnabled())
+        TrackingRealtime::applyToThread(m_processors.front()->getRealtimeConfig(), "OscListener port " + m_incomingPort);
+
+    if (m_tcp)
+    {
+        runTcp();
+        return;
+    }
+
+    // Start the oscpack OSC Listener Thread
+    try
+    {
+        m_socket.reset(openSocket(m_portNumber));
+        if (m_socket == nullptr)
+            return;
+        if (!m_processors.empty() && m_processors.front()->getRealtimeConfig().busyPoll)
+        {
+#ifdef _WIN32
+            // the Windows multiplexer always waits on socket events
+            LOGC("OscListener port ", m_incomingPort, ": busy polling is not supported on Windows, waiting for events");
+#else
+            m_multiplexer.SetSpinWait(true);
+            // openSocket already asked for SO_BUSY_POLL, this reports whether it took
+            const bool kernelPoll = m_socket->SetBusyPoll(BUSY_POLL_US);
+            LOGC("OscListener port ", m_incomingPort, ": spinning on non-blocking reads, SO_BUSY_POLL ",
+                 kernelPoll ? "set" : "not available (needs Linux and CAP_NET_ADMIN)");
+#endif
+        }
+        m_multiplexer.AttachSocketListener(m_socket.get(), this);
+
+        // Run() returns for stop() and for rebind requests, the socket is only
+        // swapped here between runs so no datagram is read from a closed socket
+        while (!m_stopRequested)
+        {
+            m_multiplexer.Run();
+            const int port = takeRebind();
+            if (port < 0)
+                continue;
+            std::unique_ptr<UdpSocket> socket(openSocket(port));
+            if (socket == nullptr)
+            {
+                LOGC("OscListener keeps listening on port ", m_incomingPort);
+                finishRebind(false);
+                continue;
+            }
+            m_multiplexer.DetachSocketListener(m_socket.get(), this);
+            m_multiplexer.AttachSocketListener(socket.get(), this);
+            m_socket.swap(socket);
+            LOGC("OscListener moved from port ", m_incomingPort, " to ", port);
+            setPortNumber(port);
+            finishRebind(true);
+        }
+        m_multiplexer.DetachSocketListener(m_socket.get(), this);
+    }
+    catch (const std::exception &e)
+    {
+        LOGC("Exception in TrackingServer::run(): ", String(e.what()));
+    }
 }
 
-void TrackingServer::stop()
+UdpSocket *TrackingServer::openSocket(int port)
 {
-    // Stop the oscpack OSC Listener Thread
-    if (!isThreadRunning())
+    std::unique_ptr<UdpSocket> socket;
+    try
     {
+        socket = std::make_unique<UdpSocket>();
+        if (m_multicast.isEmpty() && !m_reusePort)
+        {
+            socket->Bind(IpEndpointName("localhost", port));
+        }
+        else
+        {
+            unsigned long group = IpEndpointName::ANY_ADDRESS;
+            if (m_multicast.isNotEmpty())
+            {
+                group = IpEndpointName(m_multicast.toRawUTF8(), port).address;
+                if ((group >> 28) != 0xE)
+                {
+                    LOGC("ERROR: ", m_multicast, " is not a multicast address (224.0.0.0 to 239.255.255.255)");
+                    return nullptr;
+                }
+            }
+            if (m_reusePort)
+                socket->SetReusePort(true);
+            // multicast datagrams are addressed to the group, not to localhost
+            socket->Bind(m_multicast.isEmpty() ? IpEndpointName("localhost", port) : IpEndpointName(port));
+            if (group != IpEndpointName::ANY_ADDRESS)
+                socket->JoinMulticastGroup(group);
+            LOGC("Listening on port ", port, m_reusePort ? ", shared" : "",
+                 m_multicast.isNotEmpty() ? ", multicast group " + m_multicast : String());
+        }
+        socket->SetReceiveTimestamps(true);
+        if (!m_processors.empty() && m_processors.front()->getRealtimeConfig().busyPoll)
+            socket->SetBusyPoll(BUSY_POLL_US);
+    }
+    catch (const std::exception &e)
+    {
+        LOGC("ERROR: could not listen on port ", port, ": ", String(e.what()),
+             m_reusePort ? String() : String(" (turn on \"Reuse port\" on every source sharing this port)"));
+        return nullptr;
+    }
+    return socket.release();
+}
+
+bool TrackingServer::rebind(const String &port, const String &address)
+{
+    {
+        const ScopedLock rebindLock(m_rebindLock);
+        m_pendingPort = port;
+        m_pendingAddress = address;
+    }
+    m_rebindDone.reset();
+    m_rebindPending = true;
+    m_multiplexer.AsynchronousBreak();
+    // a listener that doesn't answer in time still applies the request later
+    if (!m_rebindDone.wait(REBIND_TIMEOUT_MS))
+        return true;
+    return m_rebindSucceeded;
+}
+
+void TrackingServer::finishRebind(bool succeeded)
+{
+    m_rebindSucceeded = succeeded;
+    m_rebindDone.signal();
+}
+
+int TrackingServer::takeRebind()
+{
+    if (!m_rebindPending.exchange(false))
+        return -1;
+    String port, address;
+    {
+        const ScopedLock rebindLock(m_rebindLock);
+        port = m_pendingPort;
+        address = m_pendingAddress;
+    }
+    if (address != m_address)
+    {
+        m_address = address;
+        m_oscAddress.set(address.toRawUTF8());
+    }
+    const int portNumber = port.getIntValue();
+    if (portNumber != m_portNumber)
+        return portNumber;
+    finishRebind(true);
+    return -1;
+}
+
+void TrackingServer::setPortNumber(int port)
+{
+    m_portNumber = port;
+    m_incomingPort = String(port);
+}
+
+void TrackingServer::runTcp()
+{
+    auto listener = std::make_unique<StreamingSocket>();
+    if (!listener->createListener(m_portNumber, "127.0.0.1"))
+    {
+        LOGC("ERROR: could not listen for OSC over TCP on port ", m_portNumber);
         return;
     }
+    LOGC("Listening for SLIP framed OSC over TCP on port ", m_portNumber);
+
+    // one reusable buffer, packets are decoded and dispatched in place
+    if (m_slip == nullptr)
+        m_slip = std::make_unique<TrackingSlipDecoder>();
 
-    m_listeningSocket->AsynchronousBreak();
+    // short waits so that stopThread() and rebind requests are seen without
+    // closing sockets under the thread
+    int port = -1;
+    while (!threadShouldExit())
+    {
+        if (port < 0)
+            port = takeRebind();
+        if (port >= 0)
+        {
+            auto moved = std::make_unique<StreamingSocket>();
+            if (moved->createListener(port, "127.0.0.1"))
+            {
+                listener.swap(moved);
+                LOGC("OSC over TCP moved from port ", m_portNumber, " to ", port);
+                setPortNumber(port);
+                finishRebind(true);
+            }
+            else
+            {
+                LOGC("ERROR: could not listen for OSC over TCP on port ", port, ", keeping port ", m_portNumber);
+                finishRebind(false);
+            }
+            port = -1;
+        }
+
+        if (listener->waitUntilReady(true, 100) != 1)
+            continue;
+        std::unique_ptr<StreamingSocket> client(listener->waitForNextConnection());
+        if (client == nullptr)
+            continue;
+
+        LOGC("OSC over TCP client connected on port ", m_portNumber);
+        m_slip->reset();
+        const uint64_t overflows = m_slip->overflows();
+        while (!threadShouldExit())
+        {
+            // a new address applies to the connected client, a new port ends it
+            if (m_rebindPending && (port = takeRebind()) >= 0)
+                break;
+            const int ready = client->waitUntilReady(true, 100);
+            if (ready < 0)
+                break;
+            if (ready == 0)
+                continue;
+            const int nBytes = client->read(m_slip->getWriteBuffer(), m_slip->getWriteSpace(), false);
+            if (nBytes <= 0)
+                break;
+            m_slip->commit(nBytes, this, IpEndpointName());
+        }
+        if (m_stats != nullptr)
+            m_stats->nParseErrors += m_slip->overflows() - overflows;
+        LOGC("OSC over TCP client on port ", m_portNumber, " disconnected");
+    }
+}
+
+void TrackingServer::stop()
+{
+    // Stop the oscpack OSC Listener Thread, also when it is between runs
+    m_stopRequested = true;
+    m_multiplexer.AsynchronousBreak();
 }
@@ -25,6 +25,23 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 #include <ProcessorHeaders.h>
 #include "TrackingMessage.h"
+#include "TrackingResampler.h"
+#include "TrackingFusion.h"
+#include "TrackingAssignment.h"
+#include "TrackingCalibration.h"
+#include "TrackingQuality.h"
+#include "TrackingReplay.h"
+#include "TrackingShmReceiver.h"
+#include "TrackingBroadcaster.h"
+#include "TrackingLog.h"
+#include "TrackingExporter.h"
+#include "TrackingClockSync.h"
+#include "TrackingFrames.h"
+#include "TrackingStats.h"
+#include "TrackingTrace.h"
+#include "TrackingProfiler.h"
+#include "TrackingRealtime.h"
+#include "TrackingSlip.h"
 #include "../../../plugin-GUI/Source/Utils/Utils.h"
 
 #include "oscpack/osc/OscOutboundPacketStream.h"
@@ -36,12 +53,23 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include <stdio.h>
 #include <queue>
 #include <utility>
+#include <limits>
+#include <cmath>
 
 #define BUFFER_SIZE 4096
 #define MAX_SOURCES 10
 #define DEF_PORT 27020
 #define DEF_ADDRESS "/red"
+// address of messages carrying one frame of all sources on a port
+#define BATCH_ADDRESS "/tracking/frame"
 #define DEF_COLOR "red"
+#define STREAM_SAMPLE_RATE 150
+// continuous output lags real time so both samples around each output time have arrived
+#define CONTINUOUS_DELAY_MS 40
+// SO_BUSY_POLL budget of a spinning listener
+#define BUSY_POLL_US 50
+// how long a port change waits for the listener to report whether it could bind
+#define REBIND_TIMEOUT_MS 1000
 
 inline StringArray colors = {"red",
 							 "green",
@@ -82,6 +110,91 @@ auto const desc_position = std::make_unique<MetadataDescriptor>(
 	"Tracking  position",
 	"external.tracking.position");
 
+auto const desc_direction = std::make_unique<MetadataDescriptor>(
+	MetadataDescriptor::MetadataType::FLOAT,
+	1,
+	"Head direction",
+	"Direction from the rear to the front source of a group, in radians",
+	"external.tracking.direction");
+
+auto const desc_identity = std::make_unique<MetadataDescriptor>(
+	MetadataDescriptor::MetadataType::INT32,
+	1,
+	"Identity",
+	"Persistent identity of the animal on a multi-animal source",
+	"external.tracking.identity");
+
+auto const desc_quality = std::make_unique<MetadataDescriptor>(
+	MetadataDescriptor::MetadataType::UINT8,
+	1,
+	"Quality",
+	"Tracking quality flags: 1 dropout, 2 jump, 4 stale",
+	"external.tracking.quality");
+
+// Position of each value in the metadata of a tracking event
+enum TrackingEventMetadata
+{
+	META_POSITION = 0,
+	META_PORT,
+	META_ADDRESS,
+	META_DIRECTION,
+	META_IDENTITY,
+	META_QUALITY,
+	META_BOARD_SAMPLE,
+	META_FRAME,
+	META_FRAME_LOSS,
+	META_JITTER
+};
+
+auto const desc_frame = std::make_unique<MetadataDescriptor>(
+	MetadataDescriptor::MetadataType::INT64,
+	1,
+	"Frame",
+	"Frame counter sent by the tracking source, -1 if it doesn't send one",
+	"external.tracking.frame");
+
+auto const desc_board_sample = std::make_unique<MetadataDescriptor>(
+	MetadataDescriptor::MetadataType::INT64,
+	1,
+	"Board sample",
+	"Receive time mapped onto the sample clock of the first stream, -1 before the clocks are synchronised",
+	"external.tracking.boardsample");
+
+auto const desc_frame_loss = std::make_unique<MetadataDescriptor>(
+	MetadataDescriptor::MetadataType::INT64,
+	3,
+	"Frame loss",
+	"Frames missing, duplicated and received late since acquisition started, from the source's frame counter",
+	"external.tracking.frameloss");
+
+auto const desc_jitter = std::make_unique<MetadataDescriptor>(
+	MetadataDescriptor::MetadataType::FLOAT,
+	1,
+	"Jitter",
+	"Smoothed interarrival jitter of the source's frames in ms",
+	"external.tracking.jitter");
+
+auto const desc_sync_time = std::make_unique<MetadataDescriptor>(
+	MetadataDescriptor::MetadataType::INT64,
+	1,
+	"Software time",
+	"Software timestamp (ms) at which the recording state changed",
+	"external.tracking.sync.software");
+
+auto const desc_sync_sample = std::make_unique<MetadataDescriptor>(
+	MetadataDescriptor::MetadataType::INT64,
+	1,
+	"Sample number",
+	"Tracking stream sample number at which the recording state changed",
+	"external.tracking.sync.sample");
+
+// Position of each value in the metadata of an alignment event
+enum TrackingSyncMetadata
+{
+	SYNC_SOFTWARE_TIME = 0,
+	SYNC_SAMPLE_NUMBER
+};
+
 auto const desc_color = std::make_unique<MetadataDescriptor>(
 	MetadataDescriptor::MetadataType::CHAR,
 	16,
@@ -98,17 +211,22 @@ public:
 
 	void push(const TrackingData &message);
 	TrackingData *pop();
+	TrackingData *peek();
 
 	bool isEmpty();
 	void clear();
 
 	int count();
 
+	/** Number of samples dropped because the queue was full */
+	uint64 overflows() const { return m_overflows; }
+
 private:
 	TrackingData m_buffer[BUFFER_SIZE];
 	int m_head;
 	int m_tail;
 	int _count = 0;
+	std::atomic<uint64> m_overflows{0};
 };
 
 //	This helper class is an OSC server running its own thread to keep data transmission
@@ -121,17 +239,41 @@ class TrackingServer : public osc::OscPacketListener,
 {
 public:
 	TrackingServer();
-	TrackingServer(String port, String address);
+	/** multicast is an IPv4 group to join, empty for unicast. reusePort lets
+		other sockets and processes bind the same port. tcp listens for SLIP
+		framed OSC over TCP instead of UDP datagrams. */
+	TrackingServer(String port, String address, String multicast = String(), bool reusePort = false, bool tcp = false);
 	~TrackingServer();
 
 	void run();
 	void stop();
 
+	/** Moves the listener to another port and/or OSC address while it runs.
+		The listener thread opens the new socket before closing the old one.
+		Returns false if the port can't be bound, the listener then stays on
+		getPort(). */
+	bool rebind(const String &port, const String &address);
+
+	/** Port the listener is bound to */
+	String getPort() const { return m_incomingPort; }
+
+	/** Records the wakeup latency of each datagram before parsing it */
+	void ProcessPacket(const char *data, int size, const IpEndpointName &remoteEndpoint) override;
+
 	void addProcessor(TrackingNode *processor);
 	void removeProcessor(TrackingNode *processor);
 
+	/** Counters for received messages and parse errors, must be set before the thread starts */
+	void setStats(TrackingStats *stats) { m_stats = stats; }
+
+	/** Converts an OSC (NTP) time tag to milliseconds on the host's wall clock */
+	static double ntpToMillis(uint64 timeTag);
+
 protected:
 	virtual void ProcessMessage(const osc::ReceivedMessage &m, const IpEndpointName &);
+	void ProcessBatch(const osc::ReceivedMessage &m);
+	/** Hands the bundle's time tag to its messages as their camera time */
+	virtual void ProcessBundle(const osc::ReceivedBundle &b, const IpEndpointName &remoteEndpoint);
 
 private:
 	TrackingServer(TrackingServer const &);
@@ -139,9 +281,43 @@ private:
 
 	String m_incomingPort;
 	String m_address;
-
-	UdpListeningReceiveSocket *m_listeningSocket = nullptr;
+	// encoded once here, messages are dispatched without parsing or allocating
+	int m_portNumber;
+	TrackingOscAddress m_oscAddress;
+	String m_multicast;
+	bool m_reusePort = false;
+	bool m_tcp = false;
+
+	/** Accepts one TCP client at a time and decodes its stream until it disconnects */
+	void runTcp();
+	std::unique_ptr<TrackingSlipDecoder> m_slip;
+
+	bool isMulticast() const { return m_multicast.isNotEmpty(); }
+
+	/** Binds a UDP socket to port with this server's options, nullptr on failure */
+	UdpSocket *openSocket(int port);
+	/** Applies a pending rebind's address on the listener thread. Returns the
+		port to move to, or -1 if there is none or it is unchanged. */
+	int takeRebind();
+	void setPortNumber(int port);
+	/** Reports the outcome of a rebind to the thread waiting in rebind() */
+	void finishRebind(bool succeeded);
+
+	// the listener thread runs the multiplexer and owns the socket, other
+	// threads only post requests and break it out of Run()
+	SocketReceiveMultiplexer m_multiplexer;
+	std::unique_ptr<UdpSocket> m_socket;
+	std::atomic<bool> m_stopRequested{false};
+	std::atomic<bool> m_rebindPending{false};
+	CriticalSection m_rebindLock;
+	WaitableEvent m_rebindDone;
+	std::atomic<bool> m_rebindSucceeded{true};
+	String m_pendingPort;
+	String m_pendingAddress;
 	std::vector<TrackingNode *> m_processors;
+	TrackingStats *m_stats = nullptr;
+	// time tag (ms) of the bundle being processed, -1 outside bundles
+	double m_bundleTime = -1;
 };
 
 class TrackingModule
@@ -151,17 +327,79 @@ public:
 	TrackingModule(String port, String address, String color, TrackingNode *processor)
 		: m_port(port), m_address(address), m_color(color), m_messageQueue(std::make_unique<TrackingQueue>()), m_server(std::make_unique<TrackingServer>(port, address))
 	{
-		// m_server->addProcessor(processor);
-		// m_server->startThread();
+		setPort(port);
+		setAddress(address);
+		m_server->addProcessor(processor);
+		m_server->setStats(&m_stats);
+		m_server->startThread();
 	}
 	~TrackingModule() {}
+	/** Moves the running listener to the current port and address without
+		stopping it, or starts a new one if it has exited. Returns false if
+		the listener could not move and still uses its old port. */
+	bool rebindServer(TrackingNode *processor)
+	{
+		if (m_server != nullptr && m_server->isThreadRunning())
+			return m_server->rebind(m_port, m_address);
+		restartServer(processor);
+		return true;
+	}
+	/** Replaces the listener with one using the current port and socket
+		options. Must not be called with the processor's lock held, the old
+		listener may be waiting for it. */
+	void restartServer(TrackingNode *processor)
+	{
+		m_server = std::make_unique<TrackingServer>(m_port, m_address, m_multicast, m_reusePort, m_tcp);
+		m_server->addProcessor(processor);
+		m_server->setStats(&m_stats);
+		m_server->startThread();
+	}
 	friend std::ostream &operator<<(std::ostream &, const TrackingModule &);
+	void setPort(const String &port)
+	{
+		m_port = port;
+		m_portNumber = port.getIntValue();
+	}
+	void setAddress(const String &address)
+	{
+		m_address = address;
+		m_oscAddress.set(address.toRawUTF8());
+	}
+	void setMaxSpeed(float maxSpeed)
+	{
+		for (auto &validator : m_validators)
+			validator.setMaxSpeed(maxSpeed);
+	}
+	float getMaxSpeed() const { return m_validators[0].getMaxSpeed(); }
+	TrackingValidator &getValidator(int identity) { return m_validators[jlimit(0, MAX_IDENTITIES - 1, identity)]; }
 	String m_name;
 	String m_port = String(DEF_PORT);
 	String m_address = String(DEF_ADDRESS);
+	// m_port and m_address as received messages carry them, kept in step by setPort and setAddress
+	int m_portNumber = DEF_PORT;
+	TrackingOscAddress m_oscAddress{DEF_ADDRESS};
 	String m_color = String(DEF_COLOR);
+	String m_multicast;
+	bool m_reusePort = false;
+	bool m_tcp = false;
+	String m_group;
+	int m_animals = 1;
+	TrackingIdentities m_identities;
+	String m_calibrationString;
+	TrackingCalibration m_calibration;
+	// one per identity, each animal is checked against its own last position
+	TrackingValidator m_validators[MAX_IDENTITIES];
+	TrackingFrameCounter m_frames;
+	// camera ms to software ms, for sources sending a camera time
+	TrackingClockSync m_cameraClock;
+	int m_groupIndex = -1;
+	int m_groupMember = -1;
+	uint32 m_sequence = 0;
+	// declared before the server so that it outlives the listener thread
+	TrackingStats m_stats;
 	std::unique_ptr<TrackingQueue> m_messageQueue = nullptr;
 	std::unique_ptr<TrackingServer> m_server = nullptr;
+	TrackingResampler m_resampler;
 	EventChannel *eventChannel;
 	JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(TrackingModule);
 };
@@ -174,14 +412,27 @@ public:
 	{
 		meta_position = std::make_unique<MetadataValue>(*desc_position);
 	};
-	TTLEventPtr createEvent(int idx, int64 sample_number);
+	TTLEventPtr createEvent(int idx, const TrackingData &position, int64 sample_number, int64 board_sample,
+							float direction = std::numeric_limits<float>::quiet_NaN());
 
 	std::unique_ptr<MetadataValue> meta_position = nullptr;
 	OwnedArray<TrackingModule> trackers;
+	OwnedArray<TrackingRigidBody> groups;
 	bool removeTracker(const String & moduleToRemove);
-	int getPort(int idx) { return trackers[idx]->m_port.getIntValue(); }
+	/** Rebuilds the rigid bodies from the trackers' group names, in tracker order */
+	void updateGroups();
+	/** Returns the member of a group whose next queued sample is the oldest, or -1 */
+	int getOldestMember(int group);
+	int getPort(int idx) { return trackers[idx]->m_portNumber; }
 	String getName(int idx) { return trackers[idx]->m_name; }
 	String getAddress(int idx) { return trackers[idx]->m_address; }
+	String getGroup(int idx) { return trackers[idx]->m_group; }
+	int getAnimals(int idx) { return trackers[idx]->m_animals; }
+	String getMulticast(int idx) { return trackers[idx]->m_multicast; }
+	bool getReusePort(int idx) { return trackers[idx]->m_reusePort; }
+	bool getTcp(int idx) { return trackers[idx]->m_tcp; }
+	String getCalibration(int idx) { return trackers[idx]->m_calibrationString; }
+	float getMaxSpeed(int idx) { return trackers[idx]->getMaxSpeed(); }
 	void updateTracker(int idx, Parameter *param, juce::var value);
 	void clearQueue(int idx) {
 		trackers[idx]->m_messageQueue->clear();
@@ -194,18 +445,49 @@ public:
 class TrackingNode : public GenericProcessor
 {
 private:
-	int64 m_startingRecTimeMillis;
-	int64 m_startingAcqTimeMillis;
-
 	CriticalSection lock;
 
 	bool m_positionIsUpdated;
-	bool m_isRecordingTimeLogged;
-	bool m_isAcquisitionTimeLogged;
 	bool m_isInitialized = false;
-	int m_received_msg;
+
+	// set from start/stopAcquisition, read by the listener threads
+	std::atomic<bool> m_isAcquiring{false};
+	// recording state seen by the previous process() block
+	bool m_wasRecording = false;
+	// carries one alignment event per recording start and stop
+	EventChannel *m_syncChannel = nullptr;
+
+	String m_replayFile;
+	float m_replaySpeed = 1.0f;
+	std::unique_ptr<TrackingReplay> m_replay;
+
+	String m_shmName;
+	std::unique_ptr<TrackingShmReceiver> m_shmReceiver;
+
+	String m_broadcastEndpoints;
+	std::unique_ptr<TrackingBroadcaster> m_broadcaster;
+
+	// scheduling of the listener threads, read by each one as it starts
+	TrackingRealtimeConfig m_realtime;
+
+	bool m_logEnabled = false;
+	TrackingLog m_log;
+	File m_logFile;
+	std::unique_ptr<TrackingExporter> m_exporter;
+
+	bool m_continuousEnabled = false;
+	int64 m_sampleClockStartMillis = 0;
+	int64 m_samplesProcessed = 0;
+
+	// software ms to the sample clock of the first stream, usually the acquisition board
+	TrackingClockSync m_boardClock;
 
 	StreamSettings<TrackingNodeSettings> settings;
+	// settings of the tracking stream, so that the listener threads reach the
+	// trackers without going through the stream list. Guarded by lock.
+	TrackingNodeSettings *m_trackingSettings = nullptr;
+	/** Refreshes m_trackingSettings, after every settings.update() */
+	void cacheTrackingSettings();
 
 	MetadataValueArray m_metadata;
 	MetadataValue* meta_position;
@@ -213,6 +495,12 @@ private:
 	MetadataValue* meta_name;
 	MetadataValue* meta_address;
 
+	/** Timestamps, logs and queues the blobs of one message for tracker i of
+		module, at receive time ts. Replayed messages pass log = false so that
+		they are not recorded as new data. lock must be held. */
+	void deliverMessage(TrackingNodeSettings *module, int i, const TrackingPosition *blobs, int nBlobs,
+						int64 frame, double cameraTime, int64 ts, bool log = true);
+
 	JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(TrackingNode);
 
 public:
@@ -229,10 +517,34 @@ public:
 
 	void addTracker(String moduleName, String port="", String address="", String color="");
 
+	/** Creates a module and its event channel without adding it to the settings
+		or touching the signal chain. An empty port picks the next free one. */
+	TrackingModule *createTracker(uint16 streamId, String moduleName, String port, String address, String color);
+
 	void removeTracker(const String &moduleName);
 
 	void parameterValueChanged(Parameter *param) override;
 
+	/** Rebuilds the x, y, width, height and speed channels of every tracker,
+		or removes them all if continuous output is disabled */
+	void updateContinuousChannels();
+
+	/** Opens a raw log of all trackers in the recording directory */
+	void openLog();
+
+	/** Sample of this stream at which a sample received at timestamp is placed,
+		within the current block of nSamples */
+	int64 getSampleNumber(uint64 timestamp, int nSamples) const;
+
+	/** Adds the time from receiving position to ticks to the tracker's histogram */
+	void recordLatency(TrackingModule *tracker, const TrackingData &position, int64 ticks);
+
+	/** Sample of the first stream at timestamp, or -1 */
+	int64 getBoardSample(uint64 timestamp) const;
+
+	/** Alignment event on the sync channel, on when recording starts and off when it stops */
+	TTLEventPtr createSyncEvent(bool recording, int64 softwareTime);
+
 	String getParameterValue(Parameter *);
 
 	/** Called every time the settings of an upstream plugin are changed.
@@ -246,6 +558,12 @@ public:
 		Visualizer plugins typically use this method to send data to the canvas for display purposes */
 	void process(AudioBuffer<float> &buffer) override;
 
+	/** Resets the sample clock and the per-source resamplers */
+	bool startAcquisition() override;
+
+	/** Logs the quality counters of every source */
+	bool stopAcquisition() override;
+
 	/** Saving custom settings to XML. This method is not needed to save the state of
 		Parameter objects */
 	void saveCustomParametersToXml(XmlElement *parentElement) override;
@@ -254,8 +572,37 @@ public:
 		Parameter objects*/
 	void loadCustomParametersFromXml(XmlElement *parentElement) override;
 
-	// receives a message from the osc server
-	void receiveMessage(int port, String address, const TrackingData &message);
+	/** Returns a tracker for reading its statistics, or nullptr */
+	TrackingModule *getTracker(int trackerIdx);
+
+	/** Returns the index of the tracker with the given name, or -1 */
+	int getTrackerIndex(const String &name);
+
+	/** Scheduling of the listener threads */
+	const TrackingRealtimeConfig &getRealtimeConfig() const { return m_realtime; }
+
+	/** Pushes a replayed sample into a tracker's queue. Returns false, without
+		pushing, while the queue is more than half full. */
+	bool replayMessage(int trackerIdx, const TrackingData &data);
+
+	/** Passes the raw blobs of a replayed message through identity assignment
+		and calibration like a live one, timestamped ts (software ms). Returns
+		false, without delivering, while the queue is more than half full. */
+	bool replayBlobs(int trackerIdx, const TrackingPosition *blobs, int nBlobs, int64 ts);
+
+	// receives the blobs of one message from the osc server. Sources tracking a
+	// single animal only use the first blob. frame and cameraTime (ms) are -1
+	// for sources that don't send them. address is in OSC packet form, padded to
+	// addressSize bytes (see TrackingOscAddress). A port of -1 matches sources by
+	// address only, for transports without ports.
+	void receiveMessage(int port, const char *address, int addressSize, const TrackingPosition *blobs, int nBlobs,
+						int64 frame = -1, double cameraTime = -1);
+
+	// receives a batch message carrying one frame of every source listening on
+	// port, blobs split between them in editor order, m_animals blobs each.
+	// If only is given, the blobs of other addresses are skipped.
+	void receiveBatch(int port, const TrackingPosition *blobs, int nBlobs, int64 frame, double cameraTime,
+					  const TrackingOscAddress *only = nullptr);
 };
 
 #endif
\ No newline at end of file
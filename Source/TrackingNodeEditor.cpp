@@ -27,7 +27,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 TrackingNodeEditor::TrackingNodeEditor(GenericProcessor *parentNode)
     : GenericEditor(parentNode)
 {
-    desiredWidth = 240;
+    desiredWidth = 1195;
 
     addComboBoxParameterEditor("Name", 55, 20);
 
@@ -43,8 +43,108 @@ TrackingNodeEditor::TrackingNodeEditor(GenericProcessor *parentNode)
     minusButton->setBounds(5, 40, 20, 20);
     addAndMakeVisible(minusButton.get());
 
+    traceButton = std::make_unique<UtilityButton>("trace", titleFont);
+    traceButton->addListener(this);
+    traceButton->setRadius(3.0f);
+    traceButton->setBounds(5, 70, 45, 20);
+    traceButton->setTooltip("Write the recent hot-path trace to the recording directory");
+    addAndMakeVisible(traceButton.get());
+
     addTextBoxParameterEditor("Address", 150, 70);
     addTextBoxParameterEditor("Port", 150, 20);
+    addToggleParameterEditor("Continuous", 55, 70);
+    addTextBoxParameterEditor("Group", 245, 20);
+    addTextBoxParameterEditor("Animals", 245, 70);
+    addTextBoxParameterEditor("Calibration", 340, 20);
+    addTextBoxParameterEditor("Max speed", 340, 70);
+    addTextBoxParameterEditor("Replay", 435, 20);
+    addTextBoxParameterEditor("Replay speed", 435, 70);
+    addToggleParameterEditor("Log", 530, 20);
+    addToggleParameterEditor("Profile", 620, 20);
+    addTextBoxParameterEditor("Shared memory", 720, 20);
+    addTextBoxParameterEditor("Broadcast", 720, 70);
+    addTextBoxParameterEditor("Multicast", 815, 20);
+    addToggleParameterEditor("Reuse port", 815, 70);
+    addTextBoxParameterEditor("RT priority", 910, 20);
+    addTextBoxParameterEditor("CPU affinity", 910, 70);
+    addToggleParameterEditor("Lock memory", 1005, 20);
+    addToggleParameterEditor("Busy poll", 1005, 70);
+    addToggleParameterEditor("TCP", 1100, 20);
+
+    statsPanel = std::make_unique<TrackingStatsPanel>();
+    statsPanel->setBounds(525, 48, 190, 75);
+    addAndMakeVisible(statsPanel.get());
+}
+
+void TrackingNodeEditor::startAcquisition()
+{
+    // the panel only reads counters, a low refresh rate costs the pipeline nothing
+    startTimer(500);
+}
+
+void TrackingNodeEditor::stopAcquisition()
+{
+    stopTimer();
+    // keep the last values on screen until the next run
+    timerCallback();
+}
+
+void TrackingNodeEditor::timerCallback()
+{
+    TrackingNode *processor = (TrackingNode *)getProcessor();
+    auto cparam = (CategoricalParameter *)processor->getParameter("Name");
+    statsPanel->update(processor->getTracker(processor->getTrackerIndex(cparam->getSelectedString())));
+}
+
+TrackingStatsPanel::TrackingStatsPanel()
+    : m_lastTracker(nullptr), m_lastMessages(0), m_lastUpdate(0)
+{
+}
+
+void TrackingStatsPanel::update(TrackingModule *tracker)
+{
+    m_loss.clear();
+    m_performance.clear();
+    if (tracker != nullptr)
+    {
+        const TrackingFrameCounter &f = tracker->m_frames;
+        // network or Bonsai losses show as missing frames, local ones as overflows and drops
+        m_loss.add("frames " + String((int64)f.nFrames));
+        m_loss.add("missing " + String((int64)f.nMissing));
+        m_loss.add("dup " + String((int64)f.nDuplicates) + " late " + String((int64)f.nReordered));
+        m_loss.add("overflow " + String((int64)tracker->m_messageQueue->overflows()));
+        m_loss.add("jitter " + String(f.jitter.load(), 1) + " ms");
+
+        const TrackingStats &s = tracker->m_stats;
+        const uint64 nMessages = s.nMessages;
+        const double now = Time::getMillisecondCounterHiRes();
+        double rate = 0;
+        if (tracker == m_lastTracker && now > m_lastUpdate && nMessages >= m_lastMessages)
+            rate = (nMessages - m_lastMessages) * 1000.0 / (now - m_lastUpdate);
+        m_lastMessages = nMessages;
+        m_lastUpdate = now;
+
+        m_performance.add("rate " + String(rate, 1) + " Hz");
+        m_performance.add("p50 " + String(s.latency.getPercentile(50) / 1000.0, 2) +
+                          " p99 " + String(s.latency.getPercentile(99) / 1000.0, 2) + " ms");
+        m_performance.add("max " + String(s.latency.getMax() / 1000.0, 2) + " ms");
+        m_performance.add("queue " + String(tracker->m_messageQueue->count()) + " / " + String(s.queueHighWater.load()));
+        m_performance.add("drop " + String((int64)s.nDropped) + " err " + String((int64)s.nParseErrors));
+        m_performance.add("wake " + String(s.wakeup.getPercentile(50)) + " / " + String(s.wakeup.getPercentile(99)) + " us");
+    }
+    m_lastTracker = tracker;
+    repaint();
+}
+
+void TrackingStatsPanel::paint(Graphics &g)
+{
+    g.setColour(Colours::darkgrey);
+    g.setFont(Font("Small Text", 10, Font::plain));
+    const int lineHeight = 12;
+    for (int i = 0; i < m_loss.size(); ++i)
+        g.drawText(m_loss[i], 0, i * lineHeight, getWidth() / 2, lineHeight, Justification::left, true);
+    for (int i = 0; i < m_performance.size(); ++i)
+        g.drawText(m_performance[i], getWidth() / 2, i * lineHeight, getWidth() / 2, lineHeight, Justification::left, true);
 }
 
 void TrackingNodeEditor::buttonClicked(Button *btn)
@@ -90,4 +190,13 @@ void TrackingNodeEditor::buttonClicked(Button *btn)
         cparam->setCategories(oldSources);
         updateView();
     }
+    if (btn == traceButton.get())
+    {
+        File file = CoreServices::getRecordingParentDirectory().getChildFile(
+            "tracking_trace_" + Time::getCurrentTime().formatted("%Y-%m-%d_%H-%M-%S") + ".txt");
+        if (TrackingTrace::dump(file))
+            LOGC("Wrote trace to ", file.getFullPathName());
+        else
+            LOGC("Could not write trace to ", file.getFullPathName());
+    }
 }
\ No newline at end of file
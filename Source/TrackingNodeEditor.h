@@ -28,8 +28,30 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include <EditorHeaders.h>
 
 class SourceSelectorControl;
+class TrackingModule;
 
-class TrackingNodeEditor : public GenericEditor, public Button::Listener
+//	Two columns of runtime statistics for one tracking source: losses on the
+//	left, rate, latency and queue depth on the right.
+class TrackingStatsPanel : public Component
+{
+public:
+	TrackingStatsPanel();
+
+	/** Reads the counters of tracker, nullptr clears the panel */
+	void update(TrackingModule *tracker);
+
+	void paint(Graphics &g) override;
+
+private:
+	StringArray m_loss;
+	StringArray m_performance;
+
+	TrackingModule *m_lastTracker;
+	uint64 m_lastMessages;
+	double m_lastUpdate;
+};
+
+class TrackingNodeEditor : public GenericEditor, public Button::Listener, public Timer
 {
 public:
 	/** Constructor */
@@ -40,9 +62,17 @@ public:
 
 	void buttonClicked(Button *button);
 
+	/** Refreshes the statistics of the selected source */
+	void timerCallback() override;
+
+	void startAcquisition() override;
+	void stopAcquisition() override;
+
 private:
 	std::unique_ptr<UtilityButton> plusButton;
 	std::unique_ptr<UtilityButton> minusButton;
+	std::unique_ptr<UtilityButton> traceButton;
+	std::unique_ptr<TrackingStatsPanel> statsPanel;
 	/** Generates an assertion if this class leaks */
 	JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(TrackingNodeEditor);
 };
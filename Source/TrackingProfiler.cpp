@@ -0,0 +1,161 @@
+/*
+------------------------------------------------------------------
+
+This file is part of the Open Ephys GUI
+Copyright (C) 2022 Open Ephys
+
+------------------------------------------------------------------
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "TrackingProfiler.h"
+
+#include <chrono>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    struct ProfileEvent
+    {
+        const char *name;
+        int64_t start;
+        int64_t end;
+    };
+
+    struct ThreadBuffer
+    {
+        uint32_t thread;
+        std::atomic<size_t> count{0};
+        std::atomic<uint64_t> dropped{0};
+        ProfileEvent events[PROFILE_EVENTS_PER_THREAD];
+    };
+
+    // buffers live until the plugin is unloaded, threads only keep a pointer
+    std::mutex registryLock;
+    std::vector<std::unique_ptr<ThreadBuffer>> registry;
+    thread_local ThreadBuffer *threadBuffer = nullptr;
+
+    ThreadBuffer *getThreadBuffer()
+    {
+        if (threadBuffer == nullptr)
+        {
+            std::lock_guard<std::mutex> guard(registryLock);
+            registry.push_back(std::make_unique<ThreadBuffer>());
+            threadBuffer = registry.back().get();
+            threadBuffer->thread = (uint32_t)registry.size();
+        }
+        return threadBuffer;
+    }
+
+    // names inside the trace are string literals, only quotes and backslashes need escaping
+    std::string escape(const char *text)
+    {
+        std::string escaped;
+        for (const char *c = text; *c != '\0'; ++c)
+        {
+            if (*c == '"' || *c == '\\')
+                escaped += '\\';
+            escaped += *c;
+        }
+        return escaped;
+    }
+}
+
+std::atomic<bool> TrackingProfiler::s_capturing{false};
+std::atomic<int64_t> TrackingProfiler::s_origin{0};
+
+int64_t TrackingProfiler::now()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+void TrackingProfiler::startCapture()
+{
+    std::lock_guard<std::mutex> guard(registryLock);
+    for (auto &buffer : registry)
+    {
+        buffer->count.store(0, std::memory_order_relaxed);
+        buffer->dropped.store(0, std::memory_order_relaxed);
+    }
+    s_origin = now();
+    s_capturing.store(true, std::memory_order_release);
+}
+
+void TrackingProfiler::record(const char *name, int64_t start, int64_t end)
+{
+    if (!isCapturing())
+        return;
+
+    ThreadBuffer *buffer = getThreadBuffer();
+    const size_t n = buffer->count.load(std::memory_order_relaxed);
+    if (n == PROFILE_EVENTS_PER_THREAD)
+    {
+        buffer->dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    buffer->events[n] = {name, start, end};
+    // publishes the event to the writer of the trace
+    buffer->count.store(n + 1, std::memory_order_release);
+}
+
+bool TrackingProfiler::stopCapture(const std::string &path)
+{
+    s_capturing.store(false, std::memory_order_release);
+    // let probes that were already past their check finish writing
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+
+    std::ofstream out(path);
+    if (!out)
+        return false;
+
+    const int64_t origin = s_origin;
+    out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    bool first = true;
+
+    std::lock_guard<std::mutex> guard(registryLock);
+    for (auto &buffer : registry)
+    {
+        const size_t n = buffer->count.load(std::memory_order_acquire);
+        if (n == 0)
+            continue;
+
+        // threads are labelled by their first probe, e.g. the listener by its socket receive
+        out << (first ? "" : ",\n") << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << buffer->thread
+            << ",\"args\":{\"name\":\"" << escape(buffer->events[0].name) << " (" << buffer->thread << ")\"}}";
+        first = false;
+
+        for (size_t i = 0; i < n; ++i)
+        {
+            const ProfileEvent &event = buffer->events[i];
+            if (event.start < origin)
+                continue;
+            out << ",\n{\"name\":\"" << escape(event.name) << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << buffer->thread
+                << ",\"ts\":" << (event.start - origin) / 1000.0
+                << ",\"dur\":" << (event.end - event.start) / 1000.0 << "}";
+        }
+        const uint64_t dropped = buffer->dropped.load(std::memory_order_relaxed);
+        if (dropped > 0)
+            out << ",\n{\"name\":\"dropped " << dropped << " probes\",\"ph\":\"i\",\"s\":\"t\",\"pid\":1,\"tid\":"
+                << buffer->thread << ",\"ts\":0}";
+    }
+    out << "\n]}\n";
+    return (bool)out;
+}
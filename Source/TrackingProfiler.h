@@ -0,0 +1,83 @@
+/*
+------------------------------------------------------------------
+
+This file is part of the Open Ephys GUI
+Copyright (C) 2022 Open Ephys
+
+------------------------------------------------------------------
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef TRACKINGPROFILER_H
+#define TRACKINGPROFILER_H
+
+// no JUCE here, the probes are also used inside oscpack
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+// timed scopes kept per thread and capture, later ones are counted as dropped
+#define PROFILE_EVENTS_PER_THREAD 65536
+
+//	Scoped timing probes for a timeline of the pipeline across threads. Each
+//	thread records into its own buffer, so a probe costs two clock reads and
+//	no locks while a capture runs, and one relaxed load otherwise. Stopping a
+//	capture writes the Chrome trace event format, which chrome://tracing and
+//	ui.perfetto.dev open directly:
+//		void TrackingNode::process(...)
+//		{
+//			TRACKING_PROBE("process");
+class TrackingProfiler
+{
+public:
+	static void startCapture();
+
+	/** Ends the capture and writes it to path. Returns false if the file can't be written. */
+	static bool stopCapture(const std::string &path);
+
+	static bool isCapturing() { return s_capturing.load(std::memory_order_relaxed); }
+
+	/** Nanoseconds on the capture clock */
+	static int64_t now();
+
+	static void record(const char *name, int64_t start, int64_t end);
+
+private:
+	static std::atomic<bool> s_capturing;
+	static std::atomic<int64_t> s_origin;
+};
+
+class TrackingProbe
+{
+public:
+	explicit TrackingProbe(const char *name)
+		: m_name(name), m_start(TrackingProfiler::isCapturing() ? TrackingProfiler::now() : -1) {}
+
+	~TrackingProbe()
+	{
+		if (m_start >= 0)
+			TrackingProfiler::record(m_name, m_start, TrackingProfiler::now());
+	}
+
+private:
+	const char *m_name;
+	int64_t m_start;
+};
+
+#define TRACKING_PROBE_CONCAT2(a, b) a##b
+#define TRACKING_PROBE_CONCAT(a, b) TRACKING_PROBE_CONCAT2(a, b)
+#define TRACKING_PROBE(name) TrackingProbe TRACKING_PROBE_CONCAT(trackingProbe, __LINE__)(name)
+
+#endif
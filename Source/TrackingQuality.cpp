@@ -0,0 +1,95 @@
+/*
+------------------------------------------------------------------
+
+This file is part of the Open Ephys GUI
+Copyright (C) 2022 Open Ephys
+
+------------------------------------------------------------------
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "TrackingQuality.h"
+
+#include <cmath>
+
+TrackingValidator::TrackingValidator()
+    : m_maxSpeed(0)
+{
+    reset();
+}
+
+void TrackingValidator::reset()
+{
+    nSamples = 0;
+    nDropouts = 0;
+    nJumps = 0;
+    nStale = 0;
+    m_hasReference = false;
+    m_isStale = false;
+    m_consecutiveJumps = 0;
+    m_lastArrival = 0;
+}
+
+uint8 TrackingValidator::check(const TrackingData &sample)
+{
+    uint8 quality = QUALITY_OK;
+    ++nSamples;
+    m_lastArrival = sample.timestamp;
+
+    if (m_isStale)
+    {
+        quality |= QUALITY_STALE;
+        m_isStale = false;
+    }
+
+    const TrackingPosition &p = sample.position;
+    if ((sample.quality & QUALITY_DROPOUT) || isDropout(p))
+    {
+        ++nDropouts;
+        return quality | QUALITY_DROPOUT;
+    }
+
+    if (m_hasReference && m_maxSpeed > 0 && sample.timestamp > m_reference.timestamp)
+    {
+        const float dt = (sample.timestamp - m_reference.timestamp) * 0.001f;
+        const float distance = std::hypot(p.x - m_reference.position.x, p.y - m_reference.position.y);
+        if (distance > m_maxSpeed * dt && ++m_consecutiveJumps < JUMP_ACCEPT_COUNT)
+        {
+            // the reference stays on the last good sample so a single outlier
+            // does not also flag the sample after it
+            ++nJumps;
+            return quality | QUALITY_JUMP;
+        }
+    }
+
+    m_consecutiveJumps = 0;
+    m_reference = sample;
+    m_hasReference = true;
+    return quality;
+}
+
+bool TrackingValidator::isDropout(const TrackingPosition &position)
+{
+    return !std::isfinite(position.x) || !std::isfinite(position.y) || (position.x == 0 && position.y == 0);
+}
+
+void TrackingValidator::checkStale(uint64 now)
+{
+    if (!m_isStale && m_lastArrival != 0 && now > m_lastArrival + STALE_TIMEOUT_MS)
+    {
+        m_isStale = true;
+        ++nStale;
+    }
+}
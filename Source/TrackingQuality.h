@@ -0,0 +1,86 @@
+/*
+------------------------------------------------------------------
+
+This file is part of the Open Ephys GUI
+Copyright (C) 2022 Open Ephys
+
+------------------------------------------------------------------
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef TRACKINGQUALITY_H
+#define TRACKINGQUALITY_H
+
+#include "TrackingMessage.h"
+
+#include <atomic>
+
+// a source silent for longer than this is flagged stale
+#define STALE_TIMEOUT_MS 500
+// after this many consecutive jumps the new position is accepted as real
+#define JUMP_ACCEPT_COUNT 3
+
+//	Quality flags attached to every tracking sample and event. Zero means the
+//	sample passed every check.
+enum TrackingQualityFlags
+{
+	QUALITY_OK = 0,
+	QUALITY_DROPOUT = 1 << 0, // position is NaN or exactly (0, 0)
+	QUALITY_JUMP = 1 << 1,	  // faster than the source's maximum speed
+	QUALITY_STALE = 1 << 2,	  // first sample after the source went silent
+};
+
+// flags for which the position itself should not be used
+#define QUALITY_UNUSABLE (QUALITY_DROPOUT | QUALITY_JUMP)
+
+//	Per-source validity stage. Checks each sample against the last good one
+//	and keeps counters that can be read from any thread.
+class TrackingValidator
+{
+public:
+	TrackingValidator();
+
+	void reset();
+
+	/** Maximum plausible speed in position units per second, 0 disables the check */
+	void setMaxSpeed(float maxSpeed) { m_maxSpeed = maxSpeed; }
+	float getMaxSpeed() const { return m_maxSpeed; }
+
+	/** Returns the quality flags of a sample and updates the counters. A
+		QUALITY_DROPOUT already set on the sample is kept, for dropouts
+		detected before calibration moved them off (0, 0). */
+	uint8 check(const TrackingData &sample);
+
+	/** True for a raw position Bonsai reports when it lost the blob */
+	static bool isDropout(const TrackingPosition &position);
+
+	/** Marks the source stale if nothing arrived for STALE_TIMEOUT_MS */
+	void checkStale(uint64 now);
+
+	std::atomic<uint64> nSamples;
+	std::atomic<uint64> nDropouts;
+	std::atomic<uint64> nJumps;
+	std::atomic<uint64> nStale;
+
+private:
+	float m_maxSpeed;
+	bool m_hasReference;
+	bool m_isStale;
+	int m_consecutiveJumps;
+	uint64 m_lastArrival;
+	TrackingData m_reference;
+};
+
+#endif
@@ -0,0 +1,119 @@
+/*
+------------------------------------------------------------------
+
+This file is part of the Open Ephys GUI
+Copyright (C) 2022 Open Ephys
+
+------------------------------------------------------------------
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "TrackingRealtime.h"
+
+#include <cerrno>
+#include <cstring>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+#endif
+
+uint64 TrackingRealtime::parseCpuList(const String &cpus)
+{
+    uint64 mask = 0;
+    StringArray tokens = StringArray::fromTokens(cpus, ", ", "");
+    tokens.removeEmptyStrings();
+    for (const String &token : tokens)
+    {
+        int first = token.upToFirstOccurrenceOf("-", false, false).getIntValue();
+        int last = token.containsChar('-') ? token.fromFirstOccurrenceOf("-", false, false).getIntValue() : first;
+        for (int cpu = jmax(0, first); cpu <= jmin(63, last); ++cpu)
+            mask |= (uint64)1 << cpu;
+    }
+    return mask;
+}
+
+void TrackingRealtime::applyToThread(const TrackingRealtimeConfig &config, const String &name)
+{
+    if (config.priority > 0)
+    {
+#ifdef _WIN32
+        bool ok = SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_TIME_CRITICAL) != 0;
+        LOGC(name, ": time critical priority ", ok ? "set" : "failed, error " + String((int)GetLastError()));
+#else
+        sched_param param;
+        std::memset(&param, 0, sizeof(param));
+        param.sched_priority = jlimit(sched_get_priority_min(SCHED_FIFO), sched_get_priority_max(SCHED_FIFO), config.priority);
+        int error = pthread_setschedparam(pthread_self(), SCHED_FIFO, &param);
+        if (error == 0)
+            LOGC(name, ": SCHED_FIFO priority ", param.sched_priority, " set");
+        else
+            LOGC(name, ": SCHED_FIFO priority ", param.sched_priority, " failed, ", String(strerror(error)),
+                 " (needs CAP_SYS_NICE or an rtprio limit)");
+#endif
+    }
+
+    if (config.cpuMask != 0)
+    {
+#if defined(_WIN32)
+        bool ok = SetThreadAffinityMask(GetCurrentThread(), (DWORD_PTR)config.cpuMask) != 0;
+        LOGC(name, ": CPU affinity ", String::toHexString((int64)config.cpuMask), ok ? " set" : " failed, error " + String((int)GetLastError()));
+#elif defined(__linux__)
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        for (int cpu = 0; cpu < 64; ++cpu)
+            if (config.cpuMask & ((uint64)1 << cpu))
+                CPU_SET(cpu, &set);
+        int error = pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+        if (error == 0)
+            LOGC(name, ": CPU affinity ", String::toHexString((int64)config.cpuMask), " set");
+        else
+            LOGC(name, ": CPU affinity ", String::toHexString((int64)config.cpuMask), " failed, ", String(strerror(error)));
+#else
+        LOGC(name, ": CPU affinity is not supported on this platform");
+#endif
+    }
+
+    if (config.lockMemory)
+    {
+        // mlockall also covers pages mapped later, but if it was refused by
+        // the memlock limit, touching the stack now still keeps the first
+        // messages free of page faults
+        volatile char stack[REALTIME_PREFAULT_STACK];
+        for (int i = 0; i < REALTIME_PREFAULT_STACK; i += 4096)
+            stack[i] = 0;
+        LOGC(name, ": prefaulted ", REALTIME_PREFAULT_STACK / 1024, " KB of stack");
+    }
+}
+
+bool TrackingRealtime::lockMemory(bool lock)
+{
+#ifdef _WIN32
+    if (lock)
+        LOGC("Locking memory is not supported on Windows");
+    return false;
+#else
+    int result = lock ? mlockall(MCL_CURRENT | MCL_FUTURE) : munlockall();
+    if (result == 0)
+        LOGC(lock ? "Locked" : "Unlocked", " process memory");
+    else
+        LOGC(lock ? "mlockall" : "munlockall", " failed, ", String(strerror(errno)),
+             lock ? " (raise the memlock limit)" : "");
+    return result == 0;
+#endif
+}
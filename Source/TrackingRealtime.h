@@ -0,0 +1,61 @@
+/*
+------------------------------------------------------------------
+
+This file is part of the Open Ephys GUI
+Copyright (C) 2022 Open Ephys
+
+------------------------------------------------------------------
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef TRACKINGREALTIME_H
+#define TRACKINGREALTIME_H
+
+#include <ProcessorHeaders.h>
+
+// stack touched by a listener thread at start so it never page faults later
+#define REALTIME_PREFAULT_STACK 65536
+
+// Scheduling settings for the threads receiving tracking data
+struct TrackingRealtimeConfig
+{
+	int priority = 0;	// SCHED_FIFO priority 1 - 99, 0 keeps the default scheduler
+	uint64 cpuMask = 0; // bit n pins to CPU n, 0 lets the scheduler choose
+	bool lockMemory = false;
+	bool busyPoll = false; // spin on non-blocking reads instead of sleeping in select()
+
+	bool isEnabled() const { return priority > 0 || cpuMask != 0 || lockMemory || busyPoll; }
+};
+
+//	Applies TrackingRealtimeConfig to the calling thread and the process, and
+//	logs whether each setting took effect, so that a listener isolated on its
+//	own core can be checked from the console. SCHED_FIFO needs CAP_SYS_NICE or
+//	an rtprio limit on Linux, mlockall a large enough memlock limit. Windows
+//	maps the priority to THREAD_PRIORITY_TIME_CRITICAL and has no mlockall.
+class TrackingRealtime
+{
+public:
+	/** Parses a list of CPUs such as "3" or "2,3" or "2-5" into a mask */
+	static uint64 parseCpuList(const String &cpus);
+
+	/** Applies priority and affinity to the calling thread and prefaults its
+		stack if memory is locked. name identifies the thread in the log. */
+	static void applyToThread(const TrackingRealtimeConfig &config, const String &name);
+
+	/** Locks (or unlocks) all current and future pages of the process */
+	static bool lockMemory(bool lock);
+};
+
+#endif
@@ -0,0 +1,223 @@
+/*
+------------------------------------------------------------------
+
+This file is part of the Open Ephys GUI
+Copyright (C) 2022 Open Ephys
+
+------------------------------------------------------------------
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "TrackingReplay.h"
+#include "TrackingNode.h"
+
+TrackingReplay::TrackingReplay(TrackingNode *processor, const File &file, float speed)
+    : Thread("Tracking Replay Thread"), m_processor(processor), m_file(file), m_speed(speed)
+{
+}
+
+TrackingReplay::~TrackingReplay()
+{
+    stopThread(1000);
+}
+
+bool TrackingReplay::parseLine(const String &line, String &source, TrackingData &data)
+{
+    StringArray tokens = StringArray::fromTokens(line, ",", "\"");
+    tokens.trim();
+    if (tokens.size() < 6 || !tokens[0].containsOnly("0123456789."))
+        return false;
+
+    data.timestamp = (uint64)tokens[0].getLargeIntValue();
+    source = tokens[1].unquoted();
+    data.position.x = tokens[2].getFloatValue();
+    data.position.y = tokens[3].getFloatValue();
+    data.position.width = tokens[4].getFloatValue();
+    data.position.height = tokens[5].getFloatValue();
+    data.identity = tokens.size() > 6 ? tokens[6].getIntValue() : 0;
+    return true;
+}
+
+void TrackingReplay::run()
+{
+    LOGC("Replaying ", m_file.getFullPathName(), m_speed > 0 ? " at " + String(m_speed) + "x" : " as fast as possible");
+    m_startMillis = CoreServices::getSoftwareTimestamp();
+    m_startHiRes = Time::getMillisecondCounterHiRes();
+    m_started = false;
+    m_firstTimestamp = 0;
+    m_nSamples = 0;
+
+    if (m_file.hasFileExtension("trk"))
+        playLog();
+    else
+        playCsv();
+
+    LOGC("Replay finished after ", m_nSamples, " samples");
+}
+
+void TrackingReplay::playCsv()
+{
+    FileInputStream input(m_file);
+    if (input.failedToOpen())
+    {
+        LOGC("Could not open replay file ", m_file.getFullPathName());
+        return;
+    }
+
+    while (!threadShouldExit() && !input.isExhausted())
+    {
+        String source;
+        TrackingData data;
+        if (parseLine(input.readNextLine(), source, data) && !playSample(source, data))
+            return;
+    }
+}
+
+void TrackingReplay::playLog()
+{
+    TrackingLogHeader header;
+    std::vector<TrackingLogRecord> records;
+    if (!TrackingLog::read(m_file, header, records))
+    {
+        LOGC("Could not read tracking log ", m_file.getFullPathName());
+        return;
+    }
+
+    StringArray sources;
+    for (uint32 i = 0; i < header.nSources; ++i)
+        sources.add(String::fromUTF8(header.sources[i].name, (int)strnlen(header.sources[i].name, sizeof(header.sources[i].name))));
+
+    // records of one message share its sequence number and receive time, and
+    // are complete once a later receive time shows up; other sources' records
+    // may be interleaved with them
+    struct LoggedMessage
+    {
+        String source;
+        uint32 sequence;
+        uint64 timestamp;
+        int nBlobs = 0;
+        TrackingPosition blobs[MAX_IDENTITIES];
+    };
+    std::map<uint16, LoggedMessage> pending;
+    auto flush = [this, &pending](std::map<uint16, LoggedMessage>::iterator it) {
+        const LoggedMessage &message = it->second;
+        const bool played = playMessage(message.source, message.timestamp, message.blobs, message.nBlobs);
+        pending.erase(it);
+        return played;
+    };
+
+    for (const auto &record : records)
+    {
+        if (threadShouldExit())
+            return;
+
+        for (auto it = pending.begin(); it != pending.end();)
+        {
+            auto next = std::next(it);
+            if ((it->first == record.sourceId && it->second.sequence != record.sequence) ||
+                it->second.timestamp < record.timestamp)
+            {
+                if (!flush(it))
+                    return;
+            }
+            it = next;
+        }
+
+        LoggedMessage &message = pending[record.sourceId];
+        if (message.nBlobs == 0)
+        {
+            message.source = record.sourceId < sources.size() ? sources[record.sourceId] : String(record.sourceId);
+            message.sequence = record.sequence;
+            message.timestamp = record.timestamp;
+        }
+        if (message.nBlobs < MAX_IDENTITIES)
+            message.blobs[message.nBlobs++] = {record.x, record.y, record.width, record.height};
+    }
+    while (!pending.empty())
+        if (!flush(pending.begin()))
+            return;
+}
+
+bool TrackingReplay::waitUntilDue(uint64 &timestamp)
+{
+    if (!m_started)
+    {
+        m_firstTimestamp = timestamp;
+        m_started = true;
+    }
+    const uint64 offset = timestamp > m_firstTimestamp ? timestamp - m_firstTimestamp : 0;
+
+    if (m_speed > 0)
+    {
+        const double due = m_startHiRes + offset / m_speed;
+        double remaining;
+        while ((remaining = due - Time::getMillisecondCounterHiRes()) > 1 && !threadShouldExit())
+            wait((int)remaining);
+    }
+    timestamp = m_startMillis + offset;
+    return !threadShouldExit();
+}
+
+int TrackingReplay::getTrackerIndex(const String &source)
+{
+    auto it = m_trackerIndices.find(source);
+    if (it == m_trackerIndices.end())
+    {
+        int idx = m_processor->getTrackerIndex(source);
+        if (idx == -1 && source.containsOnly("0123456789"))
+            idx = source.getIntValue();
+        if (idx == -1)
+            LOGC("Replay: no tracker named ", source, ", skipping its samples");
+        it = m_trackerIndices.emplace(source, idx).first;
+    }
+    return it->second;
+}
+
+bool TrackingReplay::playSample(const String &source, TrackingData data)
+{
+    const int idx = getTrackerIndex(source);
+    if (!waitUntilDue(data.timestamp))
+        return false;
+    if (idx == -1)
+        return true;
+
+    // when playing as fast as possible the queues are the only pacing
+    while (!m_processor->replayMessage(idx, data))
+    {
+        if (threadShouldExit())
+            return false;
+        wait(1);
+    }
+    ++m_nSamples;
+    return true;
+}
+
+bool TrackingReplay::playMessage(const String &source, uint64 timestamp, const TrackingPosition *blobs, int nBlobs)
+{
+    const int idx = getTrackerIndex(source);
+    if (!waitUntilDue(timestamp))
+        return false;
+    if (idx == -1)
+        return true;
+
+    while (!m_processor->replayBlobs(idx, blobs, nBlobs, (int64)timestamp))
+    {
+        if (threadShouldExit())
+            return false;
+        wait(1);
+    }
+    m_nSamples += nBlobs;
+    return true;
+}
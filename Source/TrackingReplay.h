@@ -0,0 +1,84 @@
+/*
+------------------------------------------------------------------
+
+This file is part of the Open Ephys GUI
+Copyright (C) 2022 Open Ephys
+
+------------------------------------------------------------------
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef TRACKINGREPLAY_H
+#define TRACKINGREPLAY_H
+
+#include <ProcessorHeaders.h>
+#include "TrackingMessage.h"
+#include "TrackingLog.h"
+
+#include <map>
+
+class TrackingNode;
+
+//	Feeds a recorded tracking session back into the per-source queues of a
+//	TrackingNode, as if it was arriving from the OSC listeners. The recording is
+//	a CSV file with one sample per line:
+//		timestamp (ms), source, x, y, width, height[, identity]
+//	where source is a tracker name or index. Lines that don't start with a
+//	number, such as a header, are skipped. Files with a .trk extension are read
+//	as raw TrackingLog files, matching sources by the names in their header.
+//	Their blobs are regrouped into the messages they arrived in and go through
+//	identity assignment and calibration again, as live data does.
+//
+//	Samples are played back at speed times real time, or as fast as the queues
+//	accept them if speed is 0. Timestamps keep their recorded spacing whatever
+//	the speed, so quality checks and fusion behave as in the original session.
+class TrackingReplay : public Thread
+{
+public:
+	TrackingReplay(TrackingNode *processor, const File &file, float speed);
+	~TrackingReplay();
+
+	void run() override;
+
+private:
+	bool parseLine(const String &line, String &source, TrackingData &data);
+	void playCsv();
+	void playLog();
+
+	/** Waits until data is due and pushes it. Returns false if the thread must stop. */
+	bool playSample(const String &source, TrackingData data);
+	/** Waits until a logged message is due and delivers its blobs. Returns false if the thread must stop. */
+	bool playMessage(const String &source, uint64 timestamp, const TrackingPosition *blobs, int nBlobs);
+
+	/** Waits until timestamp is due and moves it to the current session. Returns false if the thread must stop. */
+	bool waitUntilDue(uint64 &timestamp);
+	/** Tracker index of a source name or index, -1 if its samples are skipped */
+	int getTrackerIndex(const String &source);
+
+	TrackingNode *m_processor;
+	File m_file;
+	float m_speed;
+	std::map<String, int> m_trackerIndices;
+
+	int64 m_startMillis;
+	double m_startHiRes;
+	bool m_started;
+	uint64 m_firstTimestamp;
+	int64 m_nSamples;
+
+	JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(TrackingReplay);
+};
+
+#endif
@@ -0,0 +1,106 @@
+/*
+------------------------------------------------------------------
+
+This file is part of the Open Ephys GUI
+Copyright (C) 2022 Open Ephys
+
+------------------------------------------------------------------
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "TrackingResampler.h"
+
+#include <cmath>
+
+TrackingResampler::TrackingResampler()
+{
+    reset();
+}
+
+void TrackingResampler::reset()
+{
+    m_first = 0;
+    m_count = 0;
+    m_hasOutput = false;
+    m_lastX = 0;
+    m_lastY = 0;
+}
+
+void TrackingResampler::addSample(const TrackingData &sample)
+{
+    if (!std::isfinite(sample.position.x) || !std::isfinite(sample.position.y))
+        return;
+
+    if (m_count > 0)
+    {
+        // drop anything arriving out of order, the history must stay sorted
+        const TrackingData &last = m_history[(m_first + m_count - 1) % RESAMPLER_HISTORY];
+        if (sample.timestamp < last.timestamp)
+            return;
+    }
+
+    if (m_count == RESAMPLER_HISTORY)
+    {
+        m_first = (m_first + 1) % RESAMPLER_HISTORY;
+        --m_count;
+    }
+    m_history[(m_first + m_count) % RESAMPLER_HISTORY] = sample;
+    ++m_count;
+}
+
+bool TrackingResampler::getSample(double t, double sampleRate, float *out)
+{
+    if (m_count == 0)
+        return false;
+
+    // keep exactly one sample at or before t
+    while (m_count >= 2 && m_history[(m_first + 1) % RESAMPLER_HISTORY].timestamp <= t)
+    {
+        m_first = (m_first + 1) % RESAMPLER_HISTORY;
+        --m_count;
+    }
+
+    const TrackingPosition &a = m_history[m_first].position;
+    const double ta = (double)m_history[m_first].timestamp;
+
+    if (m_count >= 2 && ta <= t)
+    {
+        const TrackingData &next = m_history[(m_first + 1) % RESAMPLER_HISTORY];
+        const TrackingPosition &b = next.position;
+        const float alpha = (float)((t - ta) / ((double)next.timestamp - ta));
+        out[FIELD_X] = a.x + alpha * (b.x - a.x);
+        out[FIELD_Y] = a.y + alpha * (b.y - a.y);
+        out[FIELD_WIDTH] = a.width + alpha * (b.width - a.width);
+        out[FIELD_HEIGHT] = a.height + alpha * (b.height - a.height);
+    }
+    else
+    {
+        // before the first sample or past the newest one: hold
+        out[FIELD_X] = a.x;
+        out[FIELD_Y] = a.y;
+        out[FIELD_WIDTH] = a.width;
+        out[FIELD_HEIGHT] = a.height;
+    }
+
+    if (m_hasOutput)
+        out[FIELD_SPEED] = std::hypot(out[FIELD_X] - m_lastX, out[FIELD_Y] - m_lastY) * (float)sampleRate;
+    else
+        out[FIELD_SPEED] = 0;
+
+    m_lastX = out[FIELD_X];
+    m_lastY = out[FIELD_Y];
+    m_hasOutput = true;
+    return true;
+}
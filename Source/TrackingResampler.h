@@ -0,0 +1,73 @@
+/*
+------------------------------------------------------------------
+
+This file is part of the Open Ephys GUI
+Copyright (C) 2022 Open Ephys
+
+------------------------------------------------------------------
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef TRACKINGRESAMPLER_H
+#define TRACKINGRESAMPLER_H
+
+#include "TrackingMessage.h"
+
+// must hold every sample arriving within the continuous output delay
+// (CONTINUOUS_DELAY_MS, 40 ms), which is 64 samples for sources up to 1.6 kHz
+#define RESAMPLER_HISTORY 64
+
+// Order of the values written by TrackingResampler::getSample, one continuous
+// channel per field and tracking source
+enum ContinuousField
+{
+	FIELD_X = 0,
+	FIELD_Y,
+	FIELD_WIDTH,
+	FIELD_HEIGHT,
+	FIELD_SPEED,
+	NUM_CONTINUOUS_FIELDS
+};
+
+//	Resamples the irregular arrivals of one tracking source onto a fixed clock
+//	using linear interpolation between the two samples bracketing the requested
+//	time. Requested times must be non-decreasing, so history is consumed from
+//	the front and each call is amortised O(1).
+class TrackingResampler
+{
+public:
+	TrackingResampler();
+
+	void reset();
+
+	/** Adds a received sample. Samples with a non-finite position are skipped
+		so that the output bridges short dropouts. */
+	void addSample(const TrackingData &sample);
+
+	/** Writes x, y, width, height and speed (units per second) at time t (ms)
+		into out. Returns false until the first sample has been received. */
+	bool getSample(double t, double sampleRate, float *out);
+
+private:
+	TrackingData m_history[RESAMPLER_HISTORY];
+	int m_first;
+	int m_count;
+
+	bool m_hasOutput;
+	float m_lastX;
+	float m_lastY;
+};
+
+#endif
@@ -0,0 +1,240 @@
+/*
+------------------------------------------------------------------
+
+This file is part of the Open Ephys GUI
+Copyright (C) 2022 Open Ephys
+
+------------------------------------------------------------------
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "TrackingShm.h"
+
+#include <cstring>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define TRACKING_SHM_POSIX 1
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <time.h>
+#ifdef __linux__
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#endif
+#endif
+
+namespace
+{
+#ifdef __linux__
+    // shared (not FUTEX_PRIVATE) operations, the word lives in another process' mapping too
+    void futexWait(std::atomic<uint32_t> *word, uint32_t expected, int timeoutMs)
+    {
+        struct timespec timeout = {timeoutMs / 1000, (timeoutMs % 1000) * 1000000L};
+        syscall(SYS_futex, reinterpret_cast<uint32_t *>(word), FUTEX_WAIT, expected, &timeout, nullptr, 0);
+    }
+
+    void futexWake(std::atomic<uint32_t> *word)
+    {
+        syscall(SYS_futex, reinterpret_cast<uint32_t *>(word), FUTEX_WAKE, INT32_MAX, nullptr, nullptr, 0);
+    }
+#elif defined(TRACKING_SHM_POSIX)
+    // no futex: poll the word at 1 ms
+    void futexWait(std::atomic<uint32_t> *word, uint32_t expected, int timeoutMs)
+    {
+        for (int waited = 0; waited < timeoutMs && word->load(std::memory_order_acquire) == expected; ++waited)
+            usleep(1000);
+    }
+
+    void futexWake(std::atomic<uint32_t> *) {}
+#endif
+}
+
+TrackingShmRing::TrackingShmRing()
+    : m_header(nullptr), m_records(nullptr), m_size(0), m_readIndex(0), m_owner(false)
+{
+    m_name[0] = '\0';
+}
+
+TrackingShmRing::~TrackingShmRing()
+{
+    close();
+}
+
+#ifdef TRACKING_SHM_POSIX
+
+bool TrackingShmRing::create(const char *name, uint32_t capacity)
+{
+    close();
+    if (capacity == 0 || (capacity & (capacity - 1)) != 0)
+        return false;
+
+    shm_unlink(name);
+    int fd = shm_open(name, O_RDWR | O_CREAT | O_EXCL, 0600);
+    if (fd == -1)
+        return false;
+
+    m_size = sizeof(TrackingShmHeader) + (size_t)capacity * sizeof(TrackingShmRecord);
+    void *address = MAP_FAILED;
+    if (ftruncate(fd, (off_t)m_size) == 0)
+        address = mmap(nullptr, m_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (address == MAP_FAILED)
+    {
+        shm_unlink(name);
+        return false;
+    }
+
+    // a new segment is zero filled, so every record starts with sequence 0
+    m_header = static_cast<TrackingShmHeader *>(address);
+    m_records = reinterpret_cast<TrackingShmRecord *>(m_header + 1);
+    m_header->version = TRACKING_SHM_VERSION;
+    m_header->recordSize = sizeof(TrackingShmRecord);
+    m_header->capacity = capacity;
+    m_header->producerPid = (uint32_t)getpid();
+    std::atomic_thread_fence(std::memory_order_release);
+    m_header->magic = TRACKING_SHM_MAGIC;
+
+    m_owner = true;
+    strncpy(m_name, name, sizeof(m_name) - 1);
+    m_name[sizeof(m_name) - 1] = '\0';
+    return true;
+}
+
+bool TrackingShmRing::open(const char *name)
+{
+    close();
+    int fd = shm_open(name, O_RDWR, 0);
+    if (fd == -1)
+        return false;
+
+    struct stat info;
+    void *address = MAP_FAILED;
+    if (fstat(fd, &info) == 0 && (size_t)info.st_size >= sizeof(TrackingShmHeader))
+        address = mmap(nullptr, (size_t)info.st_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (address == MAP_FAILED)
+        return false;
+
+    m_size = (size_t)info.st_size;
+    m_header = static_cast<TrackingShmHeader *>(address);
+    const uint32_t capacity = m_header->capacity;
+    if (m_header->magic != TRACKING_SHM_MAGIC || m_header->version != TRACKING_SHM_VERSION ||
+        m_header->recordSize != sizeof(TrackingShmRecord) || capacity == 0 || (capacity & (capacity - 1)) != 0 ||
+        m_size < sizeof(TrackingShmHeader) + (size_t)capacity * sizeof(TrackingShmRecord))
+    {
+        close();
+        return false;
+    }
+
+    m_records = reinterpret_cast<TrackingShmRecord *>(m_header + 1);
+    m_readIndex = m_header->writeIndex.load(std::memory_order_acquire);
+    m_owner = false;
+    return true;
+}
+
+void TrackingShmRing::close()
+{
+    if (m_header != nullptr)
+        munmap(m_header, m_size);
+    if (m_owner)
+        shm_unlink(m_name);
+    m_header = nullptr;
+    m_records = nullptr;
+    m_owner = false;
+}
+
+#else
+
+bool TrackingShmRing::create(const char *, uint32_t) { return false; }
+bool TrackingShmRing::open(const char *) { return false; }
+void TrackingShmRing::close() {}
+
+#endif
+
+void TrackingShmRing::publish(const TrackingShmRecord &record)
+{
+    const uint64_t index = m_header->writeIndex.load(std::memory_order_relaxed);
+    TrackingShmRecord &slot = m_records[index & (m_header->capacity - 1)];
+
+    // readers of the slot's previous content see it change while they copy
+    slot.sequence.store(0, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    slot.frame = record.frame;
+    slot.cameraTime = record.cameraTime;
+    slot.nBlobs = record.nBlobs < TRACKING_SHM_MAX_BLOBS ? record.nBlobs : TRACKING_SHM_MAX_BLOBS;
+    memcpy(slot.address, record.address, sizeof(slot.address));
+    memcpy(slot.blobs, record.blobs, sizeof(slot.blobs));
+    slot.sequence.store(index + 1, std::memory_order_release);
+
+    m_header->writeIndex.store(index + 1, std::memory_order_release);
+    m_header->wakeup.fetch_add(1, std::memory_order_acq_rel);
+#ifdef TRACKING_SHM_POSIX
+    if (m_header->sleepers.load(std::memory_order_acquire) != 0)
+        futexWake(&m_header->wakeup);
+#endif
+}
+
+bool TrackingShmRing::read(TrackingShmRecord &record, uint64_t &overruns)
+{
+    const uint64_t capacity = m_header->capacity;
+    for (;;)
+    {
+        const uint64_t written = m_header->writeIndex.load(std::memory_order_acquire);
+        if (m_readIndex >= written)
+            return false;
+        if (written - m_readIndex > capacity)
+        {
+            overruns += written - capacity - m_readIndex;
+            m_readIndex = written - capacity;
+        }
+
+        const TrackingShmRecord &slot = m_records[m_readIndex & (capacity - 1)];
+        const uint64_t sequence = slot.sequence.load(std::memory_order_acquire);
+        record.frame = slot.frame;
+        record.cameraTime = slot.cameraTime;
+        record.nBlobs = slot.nBlobs;
+        memcpy(record.address, slot.address, sizeof(record.address));
+        memcpy(record.blobs, slot.blobs, sizeof(record.blobs));
+        std::atomic_thread_fence(std::memory_order_acquire);
+
+        if (sequence == m_readIndex + 1 && slot.sequence.load(std::memory_order_relaxed) == sequence)
+        {
+            ++m_readIndex;
+            record.address[TRACKING_SHM_ADDRESS_SIZE - 1] = '\0';
+            if (record.nBlobs > TRACKING_SHM_MAX_BLOBS)
+                record.nBlobs = TRACKING_SHM_MAX_BLOBS;
+            return true;
+        }
+        // the producer lapped the reader while it copied: count it and retry further on
+        ++overruns;
+        ++m_readIndex;
+    }
+}
+
+void TrackingShmRing::wait(int timeoutMs)
+{
+#ifdef TRACKING_SHM_POSIX
+    const uint32_t seen = m_header->wakeup.load(std::memory_order_acquire);
+    if (m_header->writeIndex.load(std::memory_order_acquire) > m_readIndex)
+        return;
+    m_header->sleepers.fetch_add(1, std::memory_order_acq_rel);
+    // re-check after announcing the sleeper, the producer may have published in between
+    if (m_header->writeIndex.load(std::memory_order_acquire) <= m_readIndex)
+        futexWait(&m_header->wakeup, seen, timeoutMs);
+    m_header->sleepers.fetch_sub(1, std::memory_order_acq_rel);
+#endif
+}
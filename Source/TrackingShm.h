@@ -0,0 +1,115 @@
+/*
+------------------------------------------------------------------
+
+This file is part of the Open Ephys GUI
+Copyright (C) 2022 Open Ephys
+
+------------------------------------------------------------------
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef TRACKINGSHM_H
+#define TRACKINGSHM_H
+
+// no JUCE here, the reference producer in Resources builds against this file alone
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+
+#define TRACKING_SHM_MAGIC 0x4D485354 // "TSHM"
+#define TRACKING_SHM_VERSION 1
+#define TRACKING_SHM_MAX_BLOBS 12
+#define TRACKING_SHM_ADDRESS_SIZE 32
+#define TRACKING_SHM_DEFAULT_CAPACITY 4096
+
+//	Layout of a tracking shared memory segment (POSIX shm_open name, host byte
+//	order), written by a single producer and read by TrackingNode:
+//		TrackingShmHeader	64 bytes
+//		TrackingShmRecord	capacity records of 256 bytes, capacity a power of two
+//	The producer fills record writeIndex % capacity, stores its sequence as
+//	writeIndex + 1, then advances writeIndex, increments wakeup and, if
+//	sleepers is non-zero, wakes them with FUTEX_WAKE on wakeup. A reader that
+//	falls more than capacity records behind skips to the oldest record still
+//	in the ring.
+
+struct TrackingShmHeader
+{
+	uint32_t magic;
+	uint32_t version;
+	uint32_t recordSize;
+	uint32_t capacity;
+	std::atomic<uint64_t> writeIndex;
+	std::atomic<uint32_t> wakeup;  // futex word
+	std::atomic<uint32_t> sleepers; // readers blocked on wakeup
+	uint32_t producerPid;
+	uint8_t reserved[28];
+};
+
+struct TrackingShmRecord
+{
+	std::atomic<uint64_t> sequence; // index + 1 once the record is complete
+	int64_t frame;					// -1 if the producer has no frame counter
+	double cameraTime;				// ms on the producer's clock, negative if unknown
+	uint32_t nBlobs;
+	uint32_t reserved;
+	char address[TRACKING_SHM_ADDRESS_SIZE]; // source address, e.g. "/red", zero padded
+	float blobs[TRACKING_SHM_MAX_BLOBS][4];	  // x, y, width, height
+};
+
+static_assert(sizeof(TrackingShmHeader) == 64, "shared memory header must stay 64 bytes");
+static_assert(sizeof(TrackingShmRecord) == 256, "shared memory records must stay 256 bytes");
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "shared memory needs lock-free 64 bit atomics");
+
+//	One end of a tracking shared memory ring. Both ends are POSIX only; on
+//	other platforms create() and open() fail.
+class TrackingShmRing
+{
+public:
+	TrackingShmRing();
+	~TrackingShmRing();
+
+	/** Producer: creates (or replaces) the segment. capacity must be a power of two. */
+	bool create(const char *name, uint32_t capacity = TRACKING_SHM_DEFAULT_CAPACITY);
+
+	/** Consumer: maps an existing segment and starts reading at its current end */
+	bool open(const char *name);
+
+	void close();
+
+	bool isOpen() const { return m_header != nullptr; }
+
+	/** Process id of the producer that created the open segment */
+	uint32_t getProducerPid() const { return m_header->producerPid; }
+
+	/** Producer: copies record into the ring and wakes the reader */
+	void publish(const TrackingShmRecord &record);
+
+	/** Consumer: copies the next record if there is one. Records overwritten
+		before they could be read are added to overruns. */
+	bool read(TrackingShmRecord &record, uint64_t &overruns);
+
+	/** Consumer: blocks until a record may be available or timeoutMs elapsed */
+	void wait(int timeoutMs);
+
+private:
+	TrackingShmHeader *m_header;
+	TrackingShmRecord *m_records;
+	size_t m_size;
+	uint64_t m_readIndex;
+	bool m_owner;
+	char m_name[64];
+};
+
+#endif
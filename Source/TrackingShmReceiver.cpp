@@ -0,0 +1,113 @@
+/*
+------------------------------------------------------------------
+
+This file is part of the Open Ephys GUI
+Copyright (C) 2022 Open Ephys
+
+------------------------------------------------------------------
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "TrackingShmReceiver.h"
+#include "TrackingNode.h"
+
+#ifndef _WIN32
+#include <cerrno>
+#include <signal.h>
+#endif
+
+TrackingShmReceiver::TrackingShmReceiver(TrackingNode *processor, const String &name)
+    : Thread("Tracking Shared Memory Thread"), m_processor(processor), m_overruns(0)
+{
+    // POSIX shared memory names start with a single slash
+    m_name = name.startsWithChar('/') ? name : "/" + name;
+}
+
+TrackingShmReceiver::~TrackingShmReceiver()
+{
+    stopThread(1000);
+    if (m_overruns > 0)
+        LOGC("Shared memory ", m_name, ": ", (int64)m_overruns, " records overwritten before they were read");
+}
+
+bool TrackingShmReceiver::connect()
+{
+    bool logged = false;
+    while (!threadShouldExit())
+    {
+        if (m_ring.open(m_name.toRawUTF8()))
+        {
+            LOGC("Reading tracking from shared memory ", m_name);
+            return true;
+        }
+        if (!logged)
+        {
+            LOGC("Waiting for a tracker to create shared memory ", m_name);
+            logged = true;
+        }
+        wait(500);
+    }
+    return false;
+}
+
+void TrackingShmReceiver::run()
+{
+#ifdef _WIN32
+    LOGC("Shared memory tracking is not supported on Windows");
+#else
+    if (m_processor->getRealtimeConfig().isEnabled())
+        TrackingRealtime::applyToThread(m_processor->getRealtimeConfig(), "Shared memory " + m_name);
+
+    TrackingShmRecord record;
+    TrackingPosition blobs[TRACKING_SHM_MAX_BLOBS];
+
+    int idleWaits = 0;
+    while (connect())
+    {
+        while (!threadShouldExit())
+        {
+            if (!m_ring.read(record, m_overruns))
+            {
+                // 100 ms waits: threadShouldExit is seen promptly without a wake from the producer
+                m_ring.wait(100);
+                // a producer that went away leaves its segment behind, look for a new one
+                if (++idleWaits >= 20)
+                {
+                    idleWaits = 0;
+                    if (kill((pid_t)m_ring.getProducerPid(), 0) != 0 && errno == ESRCH)
+                        break;
+                }
+                continue;
+            }
+            idleWaits = 0;
+
+            for (uint32 i = 0; i < record.nBlobs; ++i)
+            {
+                blobs[i].x = record.blobs[i][0];
+                blobs[i].y = record.blobs[i][1];
+                blobs[i].width = record.blobs[i][2];
+                blobs[i].height = record.blobs[i][3];
+            }
+            // re-encoded so that a producer's stray bytes after the terminator can't break matching
+            const TrackingOscAddress address(record.address);
+            m_processor->receiveMessage(-1, address.bytes, address.size, blobs, (int)record.nBlobs,
+                                        record.frame, record.cameraTime);
+        }
+        m_ring.close();
+        if (!threadShouldExit())
+            LOGC("Tracker writing shared memory ", m_name, " exited");
+    }
+#endif
+}
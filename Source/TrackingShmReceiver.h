@@ -0,0 +1,56 @@
+/*
+------------------------------------------------------------------
+
+This file is part of the Open Ephys GUI
+Copyright (C) 2022 Open Ephys
+
+------------------------------------------------------------------
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef TRACKINGSHMRECEIVER_H
+#define TRACKINGSHMRECEIVER_H
+
+#include <ProcessorHeaders.h>
+#include "TrackingShm.h"
+
+class TrackingNode;
+
+//	Reads tracking records from a shared memory ring written by a tracker on
+//	the same machine, bypassing the network stack. Each record is delivered
+//	like an OSC message carrying the same blobs, matched to sources by address
+//	alone since there is no port. The segment is reopened if the producer
+//	isn't running yet or restarts.
+class TrackingShmReceiver : public Thread
+{
+public:
+	TrackingShmReceiver(TrackingNode *processor, const String &name);
+	~TrackingShmReceiver();
+
+	void run() override;
+
+private:
+	/** Opens the segment, retrying until it exists. Returns false if the thread must stop. */
+	bool connect();
+
+	TrackingNode *m_processor;
+	String m_name;
+	TrackingShmRing m_ring;
+	uint64_t m_overruns;
+
+	JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(TrackingShmReceiver);
+};
+
+#endif
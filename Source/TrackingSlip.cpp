@@ -0,0 +1,85 @@
+/*
+------------------------------------------------------------------
+
+This file is part of the Open Ephys GUI
+Copyright (C) 2022 Open Ephys
+
+------------------------------------------------------------------
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "TrackingSlip.h"
+
+#include <cstring>
+
+TrackingSlipDecoder::TrackingSlipDecoder()
+    : m_overflows(0)
+{
+    reset();
+}
+
+void TrackingSlipDecoder::reset()
+{
+    m_packetStart = 0;
+    m_write = 0;
+    m_end = 0;
+    m_escaped = false;
+    m_discarding = false;
+}
+
+void TrackingSlipDecoder::commit(int nBytes, PacketListener *listener, const IpEndpointName &remoteEndpoint)
+{
+    // raw bytes start where the decoded ones end, decoding only ever shrinks them
+    int read = m_write;
+    m_end += nBytes;
+    while (read < m_end)
+    {
+        const unsigned char c = (unsigned char)m_buffer[read++];
+        if (c == SLIP_END)
+        {
+            if (m_write > m_packetStart && !m_discarding)
+                listener->ProcessPacket(m_buffer + m_packetStart, m_write - m_packetStart, remoteEndpoint);
+            m_discarding = false;
+            m_escaped = false;
+            m_packetStart = m_write;
+            continue;
+        }
+        if (m_escaped)
+        {
+            m_buffer[m_write++] = (char)(c == SLIP_ESC_END ? SLIP_END : c == SLIP_ESC_ESC ? SLIP_ESC : c);
+            m_escaped = false;
+        }
+        else if (c == SLIP_ESC)
+            m_escaped = true;
+        else
+            m_buffer[m_write++] = (char)c;
+    }
+
+    // keep the unfinished packet, at the front so the next read has room
+    if (m_packetStart > 0)
+    {
+        std::memmove(m_buffer, m_buffer + m_packetStart, (size_t)(m_write - m_packetStart));
+        m_write -= m_packetStart;
+        m_packetStart = 0;
+    }
+    if (m_write == SLIP_BUFFER_SIZE)
+    {
+        // a packet filling the whole buffer can't complete, skip to its end
+        ++m_overflows;
+        m_discarding = true;
+        m_write = 0;
+    }
+    m_end = m_write;
+}
@@ -0,0 +1,73 @@
+/*
+------------------------------------------------------------------
+
+This file is part of the Open Ephys GUI
+Copyright (C) 2022 Open Ephys
+
+------------------------------------------------------------------
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef TRACKINGSLIP_H
+#define TRACKINGSLIP_H
+
+// no JUCE here, the decoder only needs oscpack's listener interface
+#include "oscpack/ip/PacketListener.h"
+#include "oscpack/ip/IpEndpointName.h"
+
+#include <cstdint>
+
+#define SLIP_END 0xC0
+#define SLIP_ESC 0xDB
+#define SLIP_ESC_END 0xDC
+#define SLIP_ESC_ESC 0xDD
+// largest OSC packet accepted over a stream, longer ones are dropped
+#define SLIP_BUFFER_SIZE 65536
+
+//	Streaming SLIP (RFC 1055) decoder for OSC 1.1 over TCP. Reads go straight
+//	into the decoder's buffer and are unescaped in place, which never needs
+//	more room than the escaped bytes had, so complete packets are handed to
+//	the listener from the buffer without a copy. A packet split across reads
+//	is moved to the front of the buffer and completed by the next ones. Both
+//	the double-END and the single-END framing are accepted.
+class TrackingSlipDecoder
+{
+public:
+	TrackingSlipDecoder();
+
+	void reset();
+
+	/** Where the next read should write, and how many bytes it may write */
+	char *getWriteBuffer() { return m_buffer + m_end; }
+	int getWriteSpace() const { return SLIP_BUFFER_SIZE - m_end; }
+
+	/** Decodes nBytes just read into getWriteBuffer() and passes each
+		complete packet to listener */
+	void commit(int nBytes, PacketListener *listener, const IpEndpointName &remoteEndpoint);
+
+	/** Packets dropped because they didn't fit the buffer */
+	uint64_t overflows() const { return m_overflows; }
+
+private:
+	char m_buffer[SLIP_BUFFER_SIZE];
+	int m_packetStart; // first decoded byte of the current packet
+	int m_write;	   // end of the decoded bytes
+	int m_end;		   // end of the raw bytes
+	bool m_escaped;
+	bool m_discarding; // skipping an oversized packet up to its END
+	uint64_t m_overflows;
+};
+
+#endif
@@ -0,0 +1,77 @@
+/*
+------------------------------------------------------------------
+
+This file is part of the Open Ephys GUI
+Copyright (C) 2022 Open Ephys
+
+------------------------------------------------------------------
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "TrackingStats.h"
+
+#include <cmath>
+
+void TrackingLatencyHistogram::reset()
+{
+    for (auto &bucket : m_buckets)
+        bucket.store(0, std::memory_order_relaxed);
+    m_max = 0;
+}
+
+uint64 TrackingLatencyHistogram::getCount() const
+{
+    uint64 count = 0;
+    for (const auto &bucket : m_buckets)
+        count += bucket.load(std::memory_order_relaxed);
+    return count;
+}
+
+uint64 TrackingLatencyHistogram::getPercentile(double percentile) const
+{
+    const uint64 count = getCount();
+    if (count == 0)
+        return 0;
+
+    const uint64 rank = (uint64)std::ceil(percentile / 100.0 * (double)count);
+    uint64 seen = 0;
+    for (int b = 0; b < LATENCY_BUCKETS; ++b)
+    {
+        seen += m_buckets[b].load(std::memory_order_relaxed);
+        if (seen >= rank && seen > 0)
+            return jmin(getBucketLimit(b), getMax());
+    }
+    return getMax();
+}
+
+uint64 TrackingLatencyHistogram::getBucketLimit(int bucket)
+{
+    if (bucket < LATENCY_SUB_BUCKETS)
+        return (uint64)bucket;
+    const int exponent = bucket / LATENCY_SUB_BUCKETS + LATENCY_SUB_BITS - 1;
+    const uint64 sub = (uint64)(bucket % LATENCY_SUB_BUCKETS);
+    // largest value falling in the bucket
+    return ((LATENCY_SUB_BUCKETS + sub + 1) << (exponent - LATENCY_SUB_BITS)) - 1;
+}
+
+void TrackingStats::reset()
+{
+    nMessages = 0;
+    nParseErrors = 0;
+    nDropped = 0;
+    queueHighWater = 0;
+    latency.reset();
+    wakeup.reset();
+}
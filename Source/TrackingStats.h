@@ -0,0 +1,117 @@
+/*
+------------------------------------------------------------------
+
+This file is part of the Open Ephys GUI
+Copyright (C) 2022 Open Ephys
+
+------------------------------------------------------------------
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef TRACKINGSTATS_H
+#define TRACKINGSTATS_H
+
+#include "TrackingMessage.h"
+
+#include <atomic>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+// 16 linear sub-buckets per power of two keep every bucket within 6.25% of its values
+#define LATENCY_SUB_BITS 4
+#define LATENCY_SUB_BUCKETS (1 << LATENCY_SUB_BITS)
+// enough octaves for 2^40 us, about 12 days
+#define LATENCY_BUCKETS ((40 - LATENCY_SUB_BITS + 1) * LATENCY_SUB_BUCKETS)
+
+//	Log-linear latency histogram in the style of HdrHistogram. Recording is a
+//	bit scan and one relaxed atomic increment, so it can be called from any
+//	thread on every sample; readers walk the buckets at their own pace.
+class TrackingLatencyHistogram
+{
+public:
+	TrackingLatencyHistogram() { reset(); }
+
+	void reset();
+
+	/** Records one latency in microseconds */
+	void record(uint64 us)
+	{
+		m_buckets[getBucket(us)].fetch_add(1, std::memory_order_relaxed);
+		uint64 max = m_max.load(std::memory_order_relaxed);
+		while (us > max && !m_max.compare_exchange_weak(max, us, std::memory_order_relaxed))
+			;
+	}
+
+	uint64 getCount() const;
+
+	/** Upper bound of the bucket holding the given percentile (0-100), in microseconds */
+	uint64 getPercentile(double percentile) const;
+
+	uint64 getMax() const { return m_max.load(std::memory_order_relaxed); }
+
+private:
+	static int getBucket(uint64 us)
+	{
+		if (us < LATENCY_SUB_BUCKETS)
+			return (int)us;
+#ifdef _MSC_VER
+		unsigned long bit;
+		_BitScanReverse64(&bit, us);
+		const int exponent = (int)bit;
+#else
+		const int exponent = 63 - __builtin_clzll(us);
+#endif
+		const int bucket = (exponent - LATENCY_SUB_BITS + 1) * LATENCY_SUB_BUCKETS +
+						   (int)((us >> (exponent - LATENCY_SUB_BITS)) & (LATENCY_SUB_BUCKETS - 1));
+		return bucket < LATENCY_BUCKETS ? bucket : LATENCY_BUCKETS - 1;
+	}
+
+	static uint64 getBucketLimit(int bucket);
+
+	std::atomic<uint64> m_buckets[LATENCY_BUCKETS];
+	std::atomic<uint64> m_max;
+};
+
+//	Runtime counters of one tracking source, written by its listener thread and
+//	by process(), read by the editor.
+class TrackingStats
+{
+public:
+	TrackingStats() { reset(); }
+
+	void reset();
+
+	/** Keeps the highest queue depth seen */
+	void updateQueueDepth(int depth)
+	{
+		int highWater = queueHighWater.load(std::memory_order_relaxed);
+		while (depth > highWater && !queueHighWater.compare_exchange_weak(highWater, depth, std::memory_order_relaxed))
+			;
+	}
+
+	std::atomic<uint64> nMessages;
+	std::atomic<uint64> nParseErrors;
+	std::atomic<uint64> nDropped; // blobs without an identity
+	std::atomic<int> queueHighWater;
+
+	/** Receive to event creation */
+	TrackingLatencyHistogram latency;
+	/** Arrival in the kernel to the listener's read, the thread's wakeup latency */
+	TrackingLatencyHistogram wakeup;
+};
+
+#endif
@@ -0,0 +1,97 @@
+/*
+------------------------------------------------------------------
+
+This file is part of the Open Ephys GUI
+Copyright (C) 2022 Open Ephys
+
+------------------------------------------------------------------
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "TrackingTrace.h"
+
+#include <vector>
+#include <algorithm>
+
+TrackingTrace::Entry TrackingTrace::s_ring[TRACE_RING_SIZE];
+std::atomic<uint64> TrackingTrace::s_next{0};
+std::atomic<uint32> TrackingTrace::s_nThreads{0};
+
+void TrackingTrace::record(int level, const char *message, int64 value)
+{
+    thread_local const uint32 thread = ++s_nThreads;
+
+    const uint64 index = s_next.fetch_add(1, std::memory_order_relaxed);
+    Entry &entry = s_ring[index & (TRACE_RING_SIZE - 1)];
+    entry.sequence.store(0, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    entry.ticks.store(Time::getHighResolutionTicks(), std::memory_order_relaxed);
+    entry.message.store(message, std::memory_order_relaxed);
+    entry.value.store(value, std::memory_order_relaxed);
+    entry.thread.store(thread, std::memory_order_relaxed);
+    entry.level.store(level, std::memory_order_relaxed);
+    entry.sequence.store(index + 1, std::memory_order_release);
+}
+
+bool TrackingTrace::dump(const File &file)
+{
+    struct Copy
+    {
+        uint64 sequence;
+        int64 ticks;
+        const char *message;
+        int64 value;
+        uint32 thread;
+        int level;
+    };
+
+    std::vector<Copy> entries;
+    entries.reserve(TRACE_RING_SIZE);
+    for (Entry &entry : s_ring)
+    {
+        // seqlock read: keep the copy only if no writer touched the entry meanwhile
+        Copy copy;
+        copy.sequence = entry.sequence.load(std::memory_order_acquire);
+        copy.ticks = entry.ticks.load(std::memory_order_relaxed);
+        copy.message = entry.message.load(std::memory_order_relaxed);
+        copy.value = entry.value.load(std::memory_order_relaxed);
+        copy.thread = entry.thread.load(std::memory_order_relaxed);
+        copy.level = entry.level.load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (copy.sequence != 0 && copy.message != nullptr &&
+            entry.sequence.load(std::memory_order_relaxed) == copy.sequence)
+            entries.push_back(copy);
+    }
+    std::sort(entries.begin(), entries.end(), [](const Copy &a, const Copy &b)
+              { return a.sequence < b.sequence; });
+
+    const double microsPerTick = 1.0e6 / (double)Time::getHighResolutionTicksPerSecond();
+    const char *levels[] = {"", "debug"};
+
+    FileOutputStream out(file);
+    if (out.failedToOpen())
+        return false;
+    out.setPosition(0);
+    out.truncate();
+    out.writeText("time_us\tthread\tlevel\tmessage\tvalue\n", false, false, nullptr);
+    for (const Copy &copy : entries)
+    {
+        const double us = (double)(copy.ticks - entries.front().ticks) * microsPerTick;
+        out.writeText(String(us, 1) + "\t" + String(copy.thread) + "\t" + levels[jlimit(0, TRACE_LEVEL_DEBUG, copy.level)] + "\t" +
+                          copy.message + "\t" + String(copy.value) + "\n",
+                      false, false, nullptr);
+    }
+    return true;
+}
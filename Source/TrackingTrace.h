@@ -0,0 +1,77 @@
+/*
+------------------------------------------------------------------
+
+This file is part of the Open Ephys GUI
+Copyright (C) 2022 Open Ephys
+
+------------------------------------------------------------------
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef TRACKINGTRACE_H
+#define TRACKINGTRACE_H
+
+#include <ProcessorHeaders.h>
+
+#include <atomic>
+
+#define TRACE_LEVEL_OFF 0
+#define TRACE_LEVEL_DEBUG 1 // per sample, hot path
+
+// off unless requested, cmake -DTRACKING_TRACE=ON turns the traces on
+#ifndef TRACKING_TRACE_LEVEL
+#define TRACKING_TRACE_LEVEL TRACE_LEVEL_OFF
+#endif
+
+// entries kept by the ring, a power of two
+#define TRACE_RING_SIZE 8192
+
+//	Lock-free trace sink for the per-sample paths. A trace is a static message
+//	and one integer, stored with the high resolution time and a small thread
+//	number in a ring that overwrites its oldest entries; nothing is formatted
+//	until the ring is dumped. Trace points above TRACKING_TRACE_LEVEL compile
+//	to nothing:
+//		TRACE_DEBUG("Created TTL event", sampleNumber);
+class TrackingTrace
+{
+public:
+	static void record(int level, const char *message, int64 value);
+
+	/** Writes the ring, oldest first, as text. Safe while traces are recorded. */
+	static bool dump(const File &file);
+
+private:
+	struct Entry
+	{
+		std::atomic<uint64> sequence; // index + 1 once written, 0 while being written
+		std::atomic<int64> ticks;
+		std::atomic<const char *> message;
+		std::atomic<int64> value;
+		std::atomic<uint32> thread;
+		std::atomic<int> level;
+	};
+
+	static Entry s_ring[TRACE_RING_SIZE];
+	static std::atomic<uint64> s_next;
+	static std::atomic<uint32> s_nThreads;
+};
+
+#if TRACKING_TRACE_LEVEL >= TRACE_LEVEL_DEBUG
+#define TRACE_DEBUG(message, value) TrackingTrace::record(TRACE_LEVEL_DEBUG, message, (int64)(value))
+#else
+#define TRACE_DEBUG(message, value) ((void)0)
+#endif
+
+#endif
@@ -147,25 +147,28 @@ void TrackingVisualizer::process(AudioSampleBuffer &)
 
 void TrackingVisualizer::handleTTLEvent(TTLEventPtr event_ptr)
 {
+    TRACKING_PROBE("visualizer event");
     DataStream * stream = getDataStream(event_ptr->getStreamId());
     if (stream->getName().equalsIgnoreCase("TrackingNode datastream"))
     {
-            LOGC("got stream");
+        TRACE_DEBUG("got stream", event_ptr->getSampleNumber());
         auto chan = event_ptr->getChannelInfo();
         auto idx = chan->findMetadata(desc_name->getType(), desc_name->getLength(), desc_name->getIdentifier());
         auto val = chan->getMetadataValue(idx);
         String name;
         val->getValue(name);
         for (auto & source : sources) {
-                LOGC("got source");
+            TRACE_DEBUG("got source", source.sourceId);
             if (name.equalsIgnoreCase(source.name)) {
                 auto nMetas = chan->getMetadataCount();
                 idx = chan->findMetadata(desc_position->getType(), desc_position->getLength(), desc_position->getIdentifier());
                 if ( idx != -1 ) {
-                    auto val = event_ptr->getMetadataValue(0);
+                    auto val = event_ptr->getMetadataValue(META_POSITION);
                     Array<float> position; // x, y , height, width
                     val->getValue(position);
-                    if (!(position[0] != position[0] || position[1] != position[1]) && position[0] != 0 && position[1] != 0)
+                    uint8 quality;
+                    event_ptr->getMetadataValue(META_QUALITY)->getValue(quality);
+                    if (!(quality & QUALITY_UNUSABLE))
                     {
                         source.x_pos = position[0];
                         source.y_pos = position[1];
@@ -31,6 +31,7 @@
 
 #include "TrackingVisualizerCanvas.h"
 #include "TrackingVisualizer.h"
+#include "TrackingProfiler.h"
 
 #include <math.h>
 #include <string>
@@ -97,6 +98,7 @@ TrackingVisualizerCanvas::~TrackingVisualizerCanvas()
 
 void TrackingVisualizerCanvas::paint (Graphics& g)
 {
+    TRACKING_PROBE("canvas paint");
     float plot_height = 0.97*getHeight();
     float plot_width = 0.85*getWidth();
     float plot_bottom_left_x = 0.15*getWidth();
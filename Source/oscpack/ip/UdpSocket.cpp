@@ -39,6 +39,7 @@
 #ifdef _WIN64
 
 #include <winsock2.h>   // this must come first to prevent errors with MSVC7
+#include <ws2tcpip.h>   // for ip_mreq
 #include <windows.h>
 #include <mmsystem.h>   // for timeGetTime()
 
@@ -62,6 +63,8 @@
 #include <math.h>
 #include <errno.h>
 #include <string.h>
+#include <fcntl.h>
+#include <time.h>
 
 #endif
 
@@ -73,6 +76,7 @@
 
 #include "PacketListener.h"
 #include "TimerListener.h"
+#include "../../TrackingProfiler.h"
 
 
 
@@ -161,6 +165,35 @@ public:
         setsockopt(socket_, SOL_SOCKET, SO_REUSEADDR, &reuseAddr, sizeof(reuseAddr));
     }
 
+    void SetReusePort( bool reusePort )
+    {
+        // Windows has no SO_REUSEPORT, SO_REUSEADDR alone shares the port
+        char reuse = (char)((reusePort) ? 1 : 0); // char on win32
+        if (setsockopt(socket_, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse)) == SOCKET_ERROR) {
+            throw std::runtime_error("unable to set SO_REUSEADDR\n");
+        }
+    }
+
+    bool SetBusyPoll( int )
+    {
+        return false; // Linux only
+    }
+
+    void SetReceiveTimestamps( bool ) {}
+
+    long long LastReceiveLatencyNs() const { return -1; }
+
+    void JoinMulticastGroup( unsigned long groupAddress )
+    {
+        struct ip_mreq request;
+        std::memset( (char *)&request, 0, sizeof(request) );
+        request.imr_multiaddr.s_addr = htonl( groupAddress );
+        request.imr_interface.s_addr = htonl( INADDR_ANY );
+        if (setsockopt(socket_, IPPROTO_IP, IP_ADD_MEMBERSHIP, (const char *)&request, sizeof(request)) == SOCKET_ERROR) {
+            throw std::runtime_error("unable to join multicast group\n");
+        }
+    }
+
     IpEndpointName LocalEndpointFor( const IpEndpointName& remoteEndpoint ) const
     {
         assert( isBound_ );
@@ -286,6 +319,31 @@ void UdpSocket::SetAllowReuse( bool allowReuse )
     impl_->SetAllowReuse( allowReuse );
 }
 
+void UdpSocket::SetReusePort( bool reusePort )
+{
+    impl_->SetReusePort( reusePort );
+}
+
+void UdpSocket::JoinMulticastGroup( unsigned long groupAddress )
+{
+    impl_->JoinMulticastGroup( groupAddress );
+}
+
+bool UdpSocket::SetBusyPoll( int microseconds )
+{
+    return impl_->SetBusyPoll( microseconds );
+}
+
+void UdpSocket::SetReceiveTimestamps( bool enable )
+{
+    impl_->SetReceiveTimestamps( enable );
+}
+
+long long UdpSocket::LastReceiveLatencyNs() const
+{
+    return impl_->LastReceiveLatencyNs();
+}
+
 IpEndpointName UdpSocket::LocalEndpointFor( const IpEndpointName& remoteEndpoint ) const
 {
     return impl_->LocalEndpointFor( remoteEndpoint );
@@ -318,6 +376,7 @@ bool UdpSocket::IsBound() const
 
 std::size_t UdpSocket::ReceiveFrom( IpEndpointName& remoteEndpoint, char *data, std::size_t size )
 {
+    TRACKING_PROBE("udp receive");
     return impl_->ReceiveFrom( remoteEndpoint, data, size );
 }
 
@@ -360,6 +419,7 @@ class SocketReceiveMultiplexer::Implementation{
 
     volatile bool break_;
     HANDLE breakEvent_;
+    bool spinWait_; // not implemented here, Run() always waits for events
 
     double GetCurrentTimeMs() const
     {
@@ -372,6 +432,8 @@ class SocketReceiveMultiplexer::Implementation{
 
 public:
     Implementation()
+        : break_( false )
+        , spinWait_( false )
     {
         breakEvent_ = CreateEvent( NULL, FALSE, FALSE, NULL );
     }
@@ -423,7 +485,12 @@ public:
 
     void Run()
     {
-        break_ = false;
+        // a break requested before Run() makes it return at once, break_ is
+        // only cleared on the way out, including when a listener throws
+        struct BreakReset{
+            volatile bool& break_;
+            ~BreakReset() { break_ = false; }
+        } breakReset = { break_ };
 
         // prepare the window events which we use to wake up on incoming data
         // we use this instead of select() primarily to support the AsyncBreak()
@@ -512,6 +579,11 @@ public:
         }
     }
 
+    void SetSpinWait( bool spinWait )
+    {
+        spinWait_ = spinWait;
+    }
+
     void Break()
     {
         break_ = true;
@@ -590,6 +662,11 @@ void SocketReceiveMultiplexer::AsynchronousBreak()
     impl_->AsynchronousBreak();
 }
 
+void SocketReceiveMultiplexer::SetSpinWait( bool spinWait )
+{
+    impl_->SetSpinWait( spinWait );
+}
+
 
 #else
 
@@ -633,6 +710,8 @@ static IpEndpointName IpEndpointNameFromSockaddr( const struct sockaddr_in& sock
 class UdpSocket::Implementation{
     bool isBound_;
     bool isConnected_;
+    bool timestamping_;
+    long long lastLatencyNs_;
 
     int socket_;
     struct sockaddr_in connectedAddr_;
@@ -643,6 +722,8 @@ public:
     Implementation()
         : isBound_( false )
         , isConnected_( false )
+        , timestamping_( false )
+        , lastLatencyNs_( -1 )
         , socket_( -1 )
     {
         if( (socket_ = socket( AF_INET, SOCK_DGRAM, 0 )) == -1 ){
@@ -676,6 +757,54 @@ public:
 #endif
     }
 
+    void SetReusePort( bool reusePort )
+    {
+        int reuse = (reusePort) ? 1 : 0; // int on posix
+        if (setsockopt(socket_, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse)) < 0) {
+            throw std::runtime_error("unable to set SO_REUSEADDR\n");
+        }
+#ifdef SO_REUSEPORT
+        if (setsockopt(socket_, SOL_SOCKET, SO_REUSEPORT, &reuse, sizeof(reuse)) < 0) {
+            throw std::runtime_error("unable to set SO_REUSEPORT\n");
+        }
+#endif
+    }
+
+    bool SetBusyPoll( int microseconds )
+    {
+#ifdef SO_BUSY_POLL
+        // needs CAP_NET_ADMIN above the net.core.busy_read default
+        return setsockopt(socket_, SOL_SOCKET, SO_BUSY_POLL, &microseconds, sizeof(microseconds)) == 0;
+#else
+        (void)microseconds;
+        return false;
+#endif
+    }
+
+    void SetReceiveTimestamps( bool enable )
+    {
+#ifdef SO_TIMESTAMPNS
+        int on = (enable) ? 1 : 0;
+        timestamping_ = setsockopt(socket_, SOL_SOCKET, SO_TIMESTAMPNS, &on, sizeof(on)) == 0 && enable;
+#else
+        (void)enable;
+        timestamping_ = false;
+#endif
+    }
+
+    long long LastReceiveLatencyNs() const { return lastLatencyNs_; }
+
+    void JoinMulticastGroup( unsigned long groupAddress )
+    {
+        struct ip_mreq request;
+        std::memset( (char *)&request, 0, sizeof(request) );
+        request.imr_multiaddr.s_addr = htonl( groupAddress );
+        request.imr_interface.s_addr = htonl( INADDR_ANY );
+        if (setsockopt(socket_, IPPROTO_IP, IP_ADD_MEMBERSHIP, &request, sizeof(request)) < 0) {
+            throw std::runtime_error("unable to join multicast group\n");
+        }
+    }
+
     IpEndpointName LocalEndpointFor( const IpEndpointName& remoteEndpoint ) const
     {
         assert( isBound_ );
@@ -768,10 +897,46 @@ public:
         struct sockaddr_in fromAddr;
         socklen_t fromAddrLen = sizeof(fromAddr);
 
-        ssize_t result = recvfrom(socket_, data, size, 0,
-                    (struct sockaddr *) &fromAddr, (socklen_t*)&fromAddrLen);
-        if( result < 0 )
-            return 0;
+        ssize_t result;
+#ifdef SO_TIMESTAMPNS
+        if( timestamping_ ){
+            // the kernel's receive time comes with the datagram, the difference
+            // to now is the time the packet waited for this thread to wake up
+            struct iovec vector;
+            vector.iov_base = data;
+            vector.iov_len = size;
+            char control[CMSG_SPACE(sizeof(struct timespec))];
+            struct msghdr message;
+            std::memset( &message, 0, sizeof(message) );
+            message.msg_name = &fromAddr;
+            message.msg_namelen = fromAddrLen;
+            message.msg_iov = &vector;
+            message.msg_iovlen = 1;
+            message.msg_control = control;
+            message.msg_controllen = sizeof(control);
+
+            result = recvmsg(socket_, &message, 0);
+            if( result < 0 )
+                return 0;
+
+            lastLatencyNs_ = -1;
+            for( struct cmsghdr *c = CMSG_FIRSTHDR(&message); c != 0; c = CMSG_NXTHDR(&message, c) ){
+                if( c->cmsg_level == SOL_SOCKET && c->cmsg_type == SCM_TIMESTAMPNS ){
+                    struct timespec received, now;
+                    std::memcpy( &received, CMSG_DATA(c), sizeof(received) );
+                    clock_gettime( CLOCK_REALTIME, &now );
+                    lastLatencyNs_ = (long long)(now.tv_sec - received.tv_sec) * 1000000000LL
+                            + (now.tv_nsec - received.tv_nsec);
+                }
+            }
+        }else
+#endif
+        {
+            result = recvfrom(socket_, data, size, 0,
+                        (struct sockaddr *) &fromAddr, (socklen_t*)&fromAddrLen);
+            if( result < 0 )
+                return 0;
+        }
 
         remoteEndpoint.address = ntohl(fromAddr.sin_addr.s_addr);
         remoteEndpoint.port = ntohs(fromAddr.sin_port);
@@ -802,6 +967,31 @@ void UdpSocket::SetAllowReuse( bool allowReuse )
     impl_->SetAllowReuse( allowReuse );
 }
 
+void UdpSocket::SetReusePort( bool reusePort )
+{
+    impl_->SetReusePort( reusePort );
+}
+
+void UdpSocket::JoinMulticastGroup( unsigned long groupAddress )
+{
+    impl_->JoinMulticastGroup( groupAddress );
+}
+
+bool UdpSocket::SetBusyPoll( int microseconds )
+{
+    return impl_->SetBusyPoll( microseconds );
+}
+
+void UdpSocket::SetReceiveTimestamps( bool enable )
+{
+    impl_->SetReceiveTimestamps( enable );
+}
+
+long long UdpSocket::LastReceiveLatencyNs() const
+{
+    return impl_->LastReceiveLatencyNs();
+}
+
 IpEndpointName UdpSocket::LocalEndpointFor( const IpEndpointName& remoteEndpoint ) const
 {
     return impl_->LocalEndpointFor( remoteEndpoint );
@@ -834,6 +1024,7 @@ bool UdpSocket::IsBound() const
 
 std::size_t UdpSocket::ReceiveFrom( IpEndpointName& remoteEndpoint, char *data, std::size_t size )
 {
+    TRACKING_PROBE("udp receive");
     return impl_->ReceiveFrom( remoteEndpoint, data, size );
 }
 
@@ -872,6 +1063,16 @@ class SocketReceiveMultiplexer::Implementation{
 
     volatile bool break_;
     int breakPipe_[2]; // [0] is the reader descriptor and [1] the writer
+    bool spinWait_;
+
+    static void SpinPause()
+    {
+#if defined(__x86_64__) || defined(__i386__)
+        __builtin_ia32_pause();
+#elif defined(__aarch64__)
+        __asm__ __volatile__( "yield" );
+#endif
+    }
 
     double GetCurrentTimeMs() const
     {
@@ -884,9 +1085,15 @@ class SocketReceiveMultiplexer::Implementation{
 
 public:
     Implementation()
+        : break_( false )
+        , spinWait_( false )
     {
         if( pipe(breakPipe_) != 0 )
             throw std::runtime_error( "creation of asynchronous break pipes failed\n" );
+        // breaks that nobody waits for (spinning, or between runs) must not
+        // fill the pipe and block AsynchronousBreak()
+        fcntl( breakPipe_[0], F_SETFL, fcntl( breakPipe_[0], F_GETFL, 0 ) | O_NONBLOCK );
+        fcntl( breakPipe_[1], F_SETFL, fcntl( breakPipe_[1], F_GETFL, 0 ) | O_NONBLOCK );
     }
 
     ~Implementation()
@@ -937,11 +1144,17 @@ public:
 
     void Run()
     {
-        break_ = false;
+        // a break requested before Run() makes it return at once, break_ is
+        // only cleared on the way out, including when a listener throws
         char *data = 0;
 
         try{
 
+            // drop wakeups left over from earlier breaks
+            char stale;
+            while( read( breakPipe_[0], &stale, 1 ) > 0 )
+                ;
+
             // configure the master fd_set for select()
 
             fd_set masterfds, tempfds;
@@ -979,55 +1192,82 @@ public:
 
             struct timeval timeout;
 
-            while( !break_ ){
-                tempfds = masterfds;
-
-                struct timeval *timeoutPtr = 0;
-                if( !timerQueue_.empty() ){
-                    double timeoutMs = timerQueue_.front().first - GetCurrentTimeMs();
-                    if( timeoutMs < 0 )
-                        timeoutMs = 0;
-
-                    long timoutSecondsPart = (long)(timeoutMs * .001);
-                    timeout.tv_sec = (time_t)timoutSecondsPart;
-                    // 1000000 microseconds in a second
-                    timeout.tv_usec = (suseconds_t)((timeoutMs - (timoutSecondsPart * 1000)) * 1000);
-                    timeoutPtr = &timeout;
+            if( spinWait_ ){
+                for( std::vector< std::pair< PacketListener*, UdpSocket* > >::iterator i = socketListeners_.begin();
+                        i != socketListeners_.end(); ++i ){
+                    int fd = i->second->impl_->Socket();
+                    fcntl( fd, F_SETFL, fcntl( fd, F_GETFL, 0 ) | O_NONBLOCK );
                 }
+            }
 
-                if( select( fdmax + 1, &tempfds, 0, 0, timeoutPtr ) < 0 ){
-                    if( break_ ){
-                        break;
-                    }else if( errno == EINTR ){
-                        // on returning an error, select() doesn't clear tempfds.
-                        // so tempfds would remain all set, which would cause read( breakPipe_[0]...
-                        // below to block indefinitely. therefore if select returns EINTR we restart
-                        // the while() loop instead of continuing on to below.
-                        continue;
-                    }else{
-                        throw std::runtime_error("select failed\n");
+            while( !break_ ){
+                if( spinWait_ ){
+                    // poll every socket without sleeping, trading a core for
+                    // the scheduler wakeup select() would need
+                    bool received = false;
+                    for( std::vector< std::pair< PacketListener*, UdpSocket* > >::iterator i = socketListeners_.begin();
+                            i != socketListeners_.end(); ++i ){
+
+                        std::size_t size = i->second->impl_->ReceiveFrom( remoteEndpoint, data, MAX_BUFFER_SIZE );
+                        if( size > 0 ){
+                            received = true;
+                            i->first->ProcessPacket( data, (int)size, remoteEndpoint );
+                            if( break_ )
+                                break;
+                        }
+                    }
+                    if( !received )
+                        SpinPause();
+                }else{
+                    tempfds = masterfds;
+
+                    struct timeval *timeoutPtr = 0;
+                    if( !timerQueue_.empty() ){
+                        double timeoutMs = timerQueue_.front().first - GetCurrentTimeMs();
+                        if( timeoutMs < 0 )
+                            timeoutMs = 0;
+
+                        long timoutSecondsPart = (long)(timeoutMs * .001);
+                        timeout.tv_sec = (time_t)timoutSecondsPart;
+                        // 1000000 microseconds in a second
+                        timeout.tv_usec = (suseconds_t)((timeoutMs - (timoutSecondsPart * 1000)) * 1000);
+                        timeoutPtr = &timeout;
                     }
-                }
 
-                if( FD_ISSET( breakPipe_[0], &tempfds ) ){
-                    // clear pending data from the asynchronous break pipe
-                    char c;
-                    read( breakPipe_[0], &c, 1 );
-                }
+                    if( select( fdmax + 1, &tempfds, 0, 0, timeoutPtr ) < 0 ){
+                        if( break_ ){
+                            break;
+                        }else if( errno == EINTR ){
+                            // on returning an error, select() doesn't clear tempfds.
+                            // so tempfds would remain all set, which would cause read( breakPipe_[0]...
+                            // below to block indefinitely. therefore if select returns EINTR we restart
+                            // the while() loop instead of continuing on to below.
+                            continue;
+                        }else{
+                            throw std::runtime_error("select failed\n");
+                        }
+                    }
 
-                if( break_ )
-                    break;
+                    if( FD_ISSET( breakPipe_[0], &tempfds ) ){
+                        // clear pending data from the asynchronous break pipe
+                        char c;
+                        read( breakPipe_[0], &c, 1 );
+                    }
 
-                for( std::vector< std::pair< PacketListener*, UdpSocket* > >::iterator i = socketListeners_.begin();
-                        i != socketListeners_.end(); ++i ){
+                    if( break_ )
+                        break;
 
-                    if( FD_ISSET( i->second->impl_->Socket(), &tempfds ) ){
+                    for( std::vector< std::pair< PacketListener*, UdpSocket* > >::iterator i = socketListeners_.begin();
+                            i != socketListeners_.end(); ++i ){
 
-                        std::size_t size = i->second->ReceiveFrom( remoteEndpoint, data, MAX_BUFFER_SIZE );
-                        if( size > 0 ){
-                            i->first->ProcessPacket( data, (int)size, remoteEndpoint );
-                            if( break_ )
-                                break;
+                        if( FD_ISSET( i->second->impl_->Socket(), &tempfds ) ){
+
+                            std::size_t size = i->second->ReceiveFrom( remoteEndpoint, data, MAX_BUFFER_SIZE );
+                            if( size > 0 ){
+                                i->first->ProcessPacket( data, (int)size, remoteEndpoint );
+                                if( break_ )
+                                    break;
+                            }
                         }
                     }
                 }
@@ -1050,13 +1290,20 @@ public:
             }
 
             delete [] data;
+            break_ = false;
         }catch(...){
             if( data )
                 delete [] data;
+            break_ = false;
             throw;
         }
     }
 
+    void SetSpinWait( bool spinWait )
+    {
+        spinWait_ = spinWait;
+    }
+
     void Break()
     {
         break_ = true;
@@ -1133,6 +1380,11 @@ void SocketReceiveMultiplexer::AsynchronousBreak()
     impl_->AsynchronousBreak();
 }
 
+void SocketReceiveMultiplexer::SetSpinWait( bool spinWait )
+{
+    impl_->SetSpinWait( spinWait );
+}
+
 
 #endif
 
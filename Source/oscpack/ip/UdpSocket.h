@@ -58,7 +58,8 @@ public:
     SocketReceiveMultiplexer();
     ~SocketReceiveMultiplexer();
 
-	// only call the attach/detach methods _before_ calling Run
+	// only call the attach/detach methods _before_ calling Run, or from the
+	// thread that called it once it has returned
 
     // only one listener per socket, each socket at most once
     void AttachSocketListener( UdpSocket *socket, PacketListener *listener );
@@ -73,6 +74,12 @@ public:
 	void RunUntilSigInt();
     void Break();    // call this from a listener to exit once the listener returns
     void AsynchronousBreak(); // call this from another thread or signal handler to exit the Run() state
+                              // a break requested while not running ends the next Run() immediately
+
+    // Poll the sockets with non-blocking reads in a loop instead of sleeping
+    // in select(), keeping one core busy for the lowest wakeup latency.
+    // Call before Run(). POSIX only, ignored on Windows.
+    void SetSpinWait( bool spinWait );
 };
 
 
@@ -102,6 +109,28 @@ public:
 	// operating systems.
 	void SetAllowReuse( bool allowReuse );
 
+	// Let several sockets, in this or other processes, bind the same
+	// port so that each receives its own copy of multicast datagrams.
+	// Sets SO_REUSEADDR and, where available, SO_REUSEPORT. Call
+	// before Bind(). Unicast datagrams still reach only one socket.
+	void SetReusePort( bool reusePort );
+
+	// Join an IPv4 multicast group (address in host byte order) on
+	// the default interface. Call after Bind(), throws
+	// std::runtime_error if the group can't be joined.
+	void JoinMulticastGroup( unsigned long groupAddress );
+
+	// Let the kernel busy poll the device queue for up to microseconds
+	// on reads (SO_BUSY_POLL). Returns false where unsupported or not
+	// permitted; Linux only.
+	bool SetBusyPoll( int microseconds );
+
+	// Record the kernel receive time of each datagram (SO_TIMESTAMPNS)
+	// so that LastReceiveLatencyNs() can report how long the last
+	// datagram waited between arrival and ReceiveFrom(), -1 if unknown.
+	void SetReceiveTimestamps( bool enable );
+	long long LastReceiveLatencyNs() const;
+
 
 	// The socket is created in an unbound, unconnected state
 	// such a socket can only be used to send to an arbitrary